@@ -1,11 +1,16 @@
 #pragma once
+#include "AlternateRoutes.h"
 #include "Announcement.h"
+#include "PropagationFeatures.h"
 #include <cstdint>
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 
+struct CandidateBatch;
+
 /**
  * Autonomous System (AS) class
  * Represents a node in the internet graph
@@ -29,6 +34,10 @@ public:
     void addProvider(AS* provider);
     void addCustomer(AS* customer);
     void addPeer(AS* peer);
+    // Bulk assignment of already sorted neighbor lists (used when cloning a topology)
+    void assignRelationships(const std::vector<AS*>& providers,
+                             const std::vector<AS*>& customers,
+                             const std::vector<AS*>& peers);
     
     // Helper methods
     bool hasCustomers() const { return !customers_.empty(); }
@@ -48,11 +57,48 @@ public:
     void propagateToPeers();      // Propagate only to peers
     void propagateToCustomers();  // Propagate only to customers
     bool hasQueuedAnnouncements() const { return !incoming_queue_.empty(); }
+
+    // Propagation kernel specialized on a compile-time feature set
+    // (see PropagationFeatures.h). The methods above use DefaultPropagationFeatures.
+    template <typename Features> bool processIncomingQueueWith();
+    template <typename Features> void propagateToProvidersWith();
+    template <typename Features> void propagateToPeersWith();
+    template <typename Features> void propagateToCustomersWith();
+    void installRoute(const Announcement& ann);  // Store a route computed elsewhere (e.g. by a worker replica)
+    void clearRoutingTable();                     // Drop all routes and pending announcements
+    void swapRoutingTable(AS& other);             // Exchange routes; both drop pending announcements
+
+    // Backup paths: with a budget set, every accepted candidate is also kept
+    // in a bounded Adj-RIB-In (see AlternateSet), so failover needs no rerun
+    void setAlternateBudget(AlternateBudget* budget) { alternate_budget_ = budget; }
+    // Up to the budget's limit of next-best routes for prefix, best first,
+    // excluding the neighbor of the installed route
+    std::vector<AlternateRoute> getAlternates(const std::string& prefix) const;
+    bool hasAlternates() const { return !adj_rib_in_.empty(); }
+    void adoptAlternates(AS& other);              // Take over other's sets (e.g. a worker replica's)
     
     // ROV Support (Day 5)
     void setROVValidator(const ROVValidator* validator) { rov_validator_ = validator; }
     void setDropInvalid(bool drop) { drop_invalid_ = drop; }
     bool getDropInvalid() const { return drop_invalid_; }
+
+    // Route leaks: a leaking AS exports its peer and provider routes to its
+    // peers and providers too (see Policy::shouldExport)
+    void setLeakRoutes(bool leak) { leak_routes_ = leak; }
+    bool getLeakRoutes() const { return leak_routes_; }
+
+    // Event-driven propagation (see ASGraph::setLeakingASes): the AS keeps
+    // the latest route of each neighbor and sends only routes that changed.
+    // A neighbor that withdraws its route, or whose new route loops or is
+    // dropped by ROV, no longer counts, and the best remaining route wins.
+    bool markRoutesChanged();  // Mark every installed route to be sent; false if none
+    bool hasChangedRoutes() const { return !changed_prefixes_.empty(); }
+    template <typename Features> void sendChangedRoutesWith();  // Each changed route, or its withdrawal
+
+    // Inactive ASes take no part in propagation: announcements sent to them
+    // are discarded (see ASGraph::compactTopology and restrictToVantagePoints)
+    void setActive(bool active) { active_ = active; }
+    bool isActive() const { return active_; }
     
 private:
     uint32_t asn_;                    // Autonomous System Number (unique ID)
@@ -68,16 +114,53 @@ private:
     struct QueuedAnnouncement {
         Announcement ann;
         AS* from;
+        Relationship relationship;  // How this AS learns the route from 'from'
     };
     std::vector<QueuedAnnouncement> incoming_queue_;
     std::unordered_map<std::string, Announcement> routes_to_propagate_;
 
+    // Bounded Adj-RIB-In: prefix -> best received routes (only with a budget)
+    std::unordered_map<std::string, AlternateSet> adj_rib_in_;
+    AlternateBudget* alternate_budget_ = nullptr;
+
     // ROV (Day 5)
     const ROVValidator* rov_validator_;  // Pointer to graph's validator
     bool drop_invalid_;                   // Drop INVALID routes?
+    bool active_;                         // Takes part in propagation?
+    bool leak_routes_ = false;            // Ignores valley-free export?
+
+    // Event-driven propagation: prefix -> the latest usable route of each
+    // neighbor (an originated route under this AS itself), oldest first; and
+    // the prefixes whose installed route changed since it was last sent
+    std::unordered_map<std::string, std::vector<Announcement>> neighbor_routes_;
+    std::unordered_set<std::string> changed_prefixes_;
     
     // BGP decision process
     bool shouldAccept(const Announcement& ann, AS* from) const;
     bool isBetterPath(const Announcement& new_ann, const Announcement& old_ann) const;
+    template <typename Features>
+    bool isBetterPathWith(const Announcement& new_ann, const Announcement& old_ann) const;
+
+    // Batched best-path selection over queued candidates for one prefix
+    template <typename Features>
+    bool selectBestRoute(const uint32_t* candidates, size_t count);
+    template <typename Features>
+    bool appendCandidate(CandidateBatch& batch, uint32_t idx, const Announcement& ann) const;
+    // Decision-process fields of ann in BestPathSelector form; false if one does not fit
+    template <typename Features>
+    bool getRankFields(const Announcement& ann, uint8_t& rov_rank, uint16_t& local_pref,
+                       uint16_t& path_length, uint32_t& tie_break) const;
+    template <typename Features>
+    void recordAlternate(const Announcement& ann);
+    // Drop neighbor's alternate for prefix, refilling from the routes still held
+    template <typename Features>
+    void withdrawAlternate(const std::string& prefix, uint32_t neighbor,
+                           const std::vector<Announcement>& remaining);
+    void releaseAlternates();
+    // Take from's route for prefix (nullptr: withdrawn) and re-select
+    template <typename Features>
+    void receiveRouteWith(AS* from, Relationship relationship, const std::string& prefix,
+                          const Announcement* route);
+    void enqueueAnnouncement(const Announcement& ann, AS* from, Relationship relationship);
     void propagateToNeighbors(const Announcement& ann);
 };
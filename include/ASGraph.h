@@ -1,11 +1,15 @@
 #pragma once
 
 #include "AS.h"
+#include "ConeSet.h"
+#include "PropagationFeatures.h"
 #include "ROV.h"
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 /**
@@ -38,6 +42,100 @@ public:
     // Propagation ranks (BGPy-style hierarchical propagation)
     void computePropagationRanks();
     const std::vector<std::vector<AS*>>& getPropagationRanks() const { return propagation_ranks_; }
+
+    // Run the three-phase (up, peer, down) propagation until no RIB changes.
+    // Requires computePropagationRanks(). Returns the number of rounds (with
+    // leaking ASes, of the event-driven propagation; see setLeakingASes).
+    // The options pick a kernel instantiation once for the whole run; the
+    // overload without options uses detectPropagationOptions().
+    int propagateToConvergence();
+    int propagateToConvergence(const PropagationOptions& options);
+
+    // Cheapest feature set that gives the same result for the current state:
+    // ROV only if some AS drops invalid routes, communities only if a seeded
+    // route carries any
+    PropagationOptions detectPropagationOptions() const;
+
+    // Route leaks: asns export against valley-free (AS::setLeakRoutes), and
+    // propagation turns event-driven: every AS keeps its neighbors' latest
+    // routes and sends only changes, so that a leaked route that changes or
+    // disappears is withdrawn downstream. Copied to cloneTopology() replicas.
+    // Returns the number of ASes newly leaking.
+    size_t setLeakingASes(const std::vector<uint32_t>& asns);
+
+    // Replica with the same ASes, relationships, ROV settings, ranks and
+    // derived ASes but empty routing tables. Used to simulate prefixes on
+    // worker threads and to write finished batches.
+    std::unique_ptr<ASGraph> cloneTopology() const;
+
+    // Drop every AS's routes and pending announcements
+    void clearRoutingTables();
+
+    // Exchange every AS's routes with the same AS of other, which must share
+    // this topology (e.g. a cloneTopology() replica). Hands a finished batch
+    // to another thread in O(#ASes) without copying routes; pending
+    // announcements are dropped as in clearRoutingTables().
+    void swapRoutingTables(ASGraph& other);
+
+    // Backup paths: from now on every AS keeps up to limit next-best routes
+    // per prefix (see AlternateSet), within max_bytes in total (0: unbounded).
+    // The budget is shared with later cloneTopology() replicas. Only the
+    // inbox propagation fills it.
+    void keepAlternateRoutes(size_t limit, size_t max_bytes);
+    const AlternateBudget* getAlternateBudget() const { return alternate_budget_.get(); }
+    std::vector<AlternateRoute> findAlternateRoutes(uint32_t asn, const std::string& prefix) const;
+
+    // Number of ASes in the customer cone of asn (including asn itself);
+    // a lookup once computeCustomerCones() ran, a walk down the customers otherwise
+    size_t getCustomerConeSize(uint32_t asn) const;
+
+    // Every AS's customer cone in one bottom-up pass over the propagation
+    // ranks (requires computePropagationRanks()): an AS's cone is itself
+    // plus the union of its customers' cones, kept as compressed sets.
+    // Changing a provider-customer link drops them again.
+    void computeCustomerCones();
+    bool hasCustomerCones() const { return !cones_.empty(); }
+    size_t getCustomerConeMemoryBytes() const;
+
+    // Whether asn is in the customer cone of provider_asn (requires computeCustomerCones())
+    bool isInCustomerCone(uint32_t provider_asn, uint32_t asn) const;
+
+    // ASNs in the customer cone of asn, ascending (requires computeCustomerCones())
+    std::vector<uint32_t> getCustomerCone(uint32_t asn) const;
+
+    // Topology compaction. Marks as derived every AS (other than an origin)
+    // whose routes follow from another AS's:
+    //  - single-homed stubs: the provider's routes with the stub prepended
+    //  - with merge_equivalent, ASes with the same providers, customers, peers
+    //    and ROV policy: the lowest ASN of the group's routes with the first
+    //    hop replaced. Their announcements always lose the lowest-ASN
+    //    tie-break to that AS, so they never appear in another AS's path.
+    // Derived ASes are dropped from the propagation ranks and hold no routes;
+    // call after computePropagationRanks(). Returns the number of derived ASes.
+    size_t compactTopology(const std::unordered_set<uint32_t>& origins, bool merge_equivalent);
+    size_t getDerivedCount() const { return derived_.size(); }
+    bool isDerived(uint32_t asn) const { return derived_.count(asn) != 0; }
+
+    // Demand-driven pruning: keep active only the ASes whose routes can reach
+    // the vantage points' RIBs, i.e. the vantage points and every AS upstream
+    // of them (their final routes flow down), plus the customer cones of
+    // those ASes and of their peers (customer routes climb up or cross one
+    // peer link) - restricted to the origins and the ASes above them, the
+    // only ones that ever hold a customer route. A derived vantage point
+    // pulls in the AS it is derived from. The rest is made inactive and
+    // dropped from the propagation ranks; RIBs outside the vantage points
+    // are incomplete afterwards. Returns the number of ASes kept.
+    size_t restrictToVantagePoints(const std::vector<uint32_t>& vantage_asns,
+                                   const std::unordered_set<uint32_t>& origins);
+
+    // Undo compactTopology() and restrictToVantagePoints(), which depend on
+    // the origins, so the topology can be reused for other announcements:
+    // every AS is active and back in its rank, and all routes are dropped
+    void restoreTopology();
+
+    // Routes of any AS, materialized on the fly for derived ASes
+    std::unordered_map<std::string, Announcement> getRoutingTable(uint32_t asn) const;
+    std::optional<Announcement> findRoute(uint32_t asn, const std::string& prefix) const;
     
 private:
     std::map<uint32_t, std::unique_ptr<AS>> ases_;
@@ -47,6 +145,27 @@ private:
     // Propagation ranks: ASes grouped by hierarchy level
     std::vector<std::vector<AS*>> propagation_ranks_;
 
+    // Derived ASes (see compactTopology) and the AS their routes come from
+    struct DerivedAS {
+        const AS* source;
+        bool stub;  // true: source is the provider; false: an equivalent AS
+    };
+    std::unordered_map<uint32_t, DerivedAS> derived_;
+
+    // Customer cones over dense indices in ASN order (see computeCustomerCones)
+    std::vector<ConeSet> cones_;
+    std::vector<uint32_t> cone_asns_;
+    std::unordered_map<uint32_t, uint32_t> cone_index_;
+
+    std::shared_ptr<AlternateBudget> alternate_budget_;  // See keepAlternateRoutes
+    bool keep_neighbor_routes_ = false;                  // See setLeakingASes
+
+    void dropInactiveFromRanks();
+
+    // Route of a derived AS built from its source's route, if it keeps one
+    std::optional<Announcement> deriveRoute(const AS& as_obj, const DerivedAS& derived,
+                                            const Announcement& source_route) const;
+
     // Cycle detection helper
     bool hasCycleDFS(const AS* node,
                      std::unordered_map<uint32_t, int>& visited,
@@ -55,4 +174,8 @@ private:
 
     // Propagation rank helpers
     void assignRanksHelper(AS* as_obj, int rank);
+
+    // Propagation loop for one kernel instantiation
+    template <typename Features> int propagateToConvergenceWith();
+    template <typename Features> int propagateEventsWith();
 };
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ASGraph.h"
+#include "CSVInput.h"
+#include "IndexedGraph.h"
+#include "ROV.h"
+#include "Scheduler.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Monte Carlo ROV-adoption sweep
+ * For each adoption percentage, every trial draws a random set of adopting
+ * ASes (uniformly, or weighted by customer-cone size) and solves each
+ * contested prefix - one with a ROV-invalid origin - with the three-stage
+ * route solver, without building paths or RIBs. A trial reduces to the
+ * share of (AS, prefix) pairs, origins excluded, whose route leads to an
+ * invalid origin (hijacked), a valid or unknown one (legitimate) or nowhere
+ * (disconnected). Trials run in parallel over one shared IndexedGraph and
+ * are summarized per percentage as mean and 95% confidence interval.
+ */
+class AdoptionSweep {
+public:
+    enum class Weighting { UNIFORM, CUSTOMER_CONE };
+
+    // Shares of one trial
+    struct Outcome {
+        double hijacked = 0.0;
+        double legitimate = 0.0;
+        double disconnected = 0.0;
+        double hijacked_adopting = 0.0;      // Among adopting ASes
+        double hijacked_non_adopting = 0.0;  // Among the others
+    };
+
+    // graph must have its propagation ranks computed; ROAs come from the
+    // valid announcements
+    AdoptionSweep(const ASGraph& graph, const std::vector<InputAnnouncement>& announcements,
+                  size_t num_threads);
+
+    size_t getContestedPrefixCount() const { return tasks_.size(); }
+
+    // Run trials per percentage (each in [0, 100]). Each trial seeds its own
+    // generator from (seed, percentage, trial), so results do not depend on
+    // the thread count.
+    void run(const std::vector<double>& percents, size_t trials, uint64_t seed,
+             Weighting weighting);
+
+    // One row per percentage: adoption_pct,trials,adopters, then mean and
+    // ci95 of every Outcome field
+    bool writeCSV(const std::string& filename) const;
+
+    const WorkStealingExecutor& getExecutor() const { return executor_; }
+
+private:
+    IndexedGraph topology_;
+    ROVValidator validator_;
+    std::vector<PrefixTask> tasks_;                   // Contested prefixes
+    std::vector<std::vector<uint32_t>> origins_;      // Origin indices per task
+    WorkStealingExecutor executor_;
+
+    std::vector<double> percents_;
+    std::vector<size_t> adopters_;                    // Adopters per percentage
+    size_t trials_ = 0;
+    std::vector<Outcome> outcomes_;                   // Percentage-major
+    std::vector<double> cone_sizes_;                  // Customer-cone size per index
+};
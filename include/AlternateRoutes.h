@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Announcement.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * One route read back from an AlternateSet (a copy; the set itself keeps
+ * its paths in its own block)
+ */
+struct AlternateRoute {
+    uint64_t key = 0;                 // BestPathSelector::packKey rank; larger is better
+    std::vector<uint32_t> path;       // AS path, the holding AS first
+    Relationship relationship = Relationship::PROVIDER;
+    ROVState rov_state = ROVState::UNKNOWN;
+
+    // Neighbor the route was learned from
+    uint32_t getNeighbor() const { return path[path.size() > 1 ? 1 : 0]; }
+};
+
+/**
+ * Bounded Adj-RIB-In of one AS for one prefix
+ * Keeps the latest route from each neighbor, ranked by the decision
+ * process: the best route plus up to k runners-up. A newer route from a
+ * neighbor replaces that neighbor's entry; a route that ranks below a full
+ * set is dropped, and a withdrawn one leaves a gap for the holder to refill. The entries live in one block sized for capacity routes,
+ * each a fixed-width slot (rank fields, then the path inline); the slot
+ * width grows to the longest path offered so far.
+ */
+class AlternateSet {
+public:
+    static constexpr size_t kMaxAlternates = 4;
+
+    AlternateSet() = default;
+    explicit AlternateSet(size_t capacity) : capacity_(static_cast<uint8_t>(capacity)) {}
+
+    // Insert a route, keeping at most capacity entries
+    void offer(uint64_t key, const std::vector<uint32_t>& path, Relationship relationship,
+               ROVState rov_state);
+    // Drop neighbor's route; false if the set holds none from it
+    bool withdraw(uint32_t neighbor);
+
+    // Entries, best first
+    size_t size() const { return count_; }
+    uint32_t getNeighbor(size_t i) const;
+    AlternateRoute getRoute(size_t i) const;
+
+    // Bytes held, including the block and the routing table entry
+    size_t getMemoryBytes() const;
+
+private:
+    // Slot layout in words: key (two), path length, relationship | ROV state << 8, path
+    static constexpr size_t kSlotHeaderWords = 4;
+    static constexpr size_t kMinPathWords = 6;
+
+    std::unique_ptr<uint32_t[]> block_;
+    uint32_t path_words_ = 0;  // Hops each slot holds
+    uint8_t capacity_ = 0;
+    uint8_t count_ = 0;
+
+    size_t getSlotWords() const { return kSlotHeaderWords + path_words_; }
+    uint32_t* getSlot(size_t i) const { return block_.get() + i * getSlotWords(); }
+    uint64_t getKey(size_t i) const;
+    void reserve(size_t path_length);
+};
+
+/**
+ * Limits shared by every AS (and worker replica) keeping alternates
+ * Once used_bytes reaches max_bytes no new (AS, prefix) set is created;
+ * sets already kept stay complete, as they are bounded by limit + 1
+ * entries.
+ */
+struct AlternateBudget {
+    size_t limit = 2;                      // Alternates kept per AS and prefix
+    size_t max_bytes = 0;                  // 0: unbounded
+    std::atomic<size_t> used_bytes{0};
+    std::atomic<size_t> refused_routes{0};  // Received routes with no set to go to
+
+    bool isExhausted() const { return max_bytes > 0 && used_bytes >= max_bytes; }
+};
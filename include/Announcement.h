@@ -38,6 +38,7 @@ public:
     // Path manipulation
     void prependASPath(uint32_t asn);
     void prependASPath(uint32_t asn, int count);  // Prepend multiple times (Day 6)
+    void setASPath(const std::vector<uint32_t>& path) { as_path_ = path; }  // Path rebuilt by array engines
     bool hasASN(uint32_t asn) const;
     int getPathLength() const { return as_path_.size(); }
     
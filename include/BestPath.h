@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Structure-of-arrays batch of candidate routes for one prefix
+ * Fields hold the decision-process inputs in ranking order; packKeys()
+ * folds them into one 64-bit key per candidate where a larger key is a
+ * better route:
+ *
+ *   bits 62-63  ROV rank (VALID=2, UNKNOWN=1, INVALID=0; 0 when ROV is off)
+ *   bits 48-61  local preference
+ *   bits 32-47  0xFFFF - AS path length
+ *   bits  0-31  tie-break value (e.g. ~neighbor ASN)
+ */
+struct CandidateBatch {
+    std::vector<uint32_t> index;        // Caller's handle for each candidate
+    std::vector<uint8_t> rov_rank;
+    std::vector<uint16_t> local_pref;
+    std::vector<uint16_t> path_length;
+    std::vector<uint32_t> tie_break;
+    std::vector<uint64_t> keys;         // Filled by BestPathSelector::packKeys
+
+    size_t size() const { return index.size(); }
+    bool empty() const { return index.empty(); }
+    void clear();
+    void add(uint32_t idx, uint8_t rov, uint16_t pref, uint16_t length, uint32_t tie);
+};
+
+/**
+ * Best-path selection over packed keys
+ * argmax() uses AVX2 when the CPU supports it (checked once at runtime)
+ * and a scalar loop otherwise.
+ */
+class BestPathSelector {
+public:
+    // Largest values each field can hold
+    static constexpr int kMaxLocalPref = 0x3FFF;
+    static constexpr int kMaxPathLength = 0xFFFF;
+
+    static uint64_t packKey(uint8_t rov_rank, uint16_t local_pref,
+                            uint16_t path_length, uint32_t tie_break) {
+        return (static_cast<uint64_t>(rov_rank & 0x3) << 62) |
+               (static_cast<uint64_t>(local_pref & kMaxLocalPref) << 48) |
+               (static_cast<uint64_t>(kMaxPathLength - path_length) << 32) |
+               tie_break;
+    }
+
+    // Fill batch.keys from the SoA fields
+    static void packKeys(CandidateBatch& batch);
+
+    // Index of the first maximum key (n must be > 0)
+    static size_t argmax(const uint64_t* keys, size_t n);
+
+    // "avx2" or "scalar"
+    static const char* getKernelName();
+};
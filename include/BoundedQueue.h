@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+/**
+ * Blocking FIFO with a fixed capacity, connecting two pipeline stages
+ * push() blocks while the queue is full and pop() while it is empty, so a
+ * fast producer is throttled to its consumer. The time each side spends
+ * blocked and the queue depth seen by every push are recorded: a stage that
+ * mostly waits on its input is not the bottleneck.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    // False if the queue was closed (the item is dropped)
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto start = std::chrono::steady_clock::now();
+        not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        push_wait_ += std::chrono::steady_clock::now() - start;
+        if (closed_) {
+            return false;
+        }
+
+        items_.push_back(std::move(item));
+        pushes_++;
+        depth_sum_ += items_.size();
+        high_water_ = std::max(high_water_, items_.size());
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // False once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto start = std::chrono::steady_clock::now();
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        pop_wait_ += std::chrono::steady_clock::now() - start;
+        if (items_.empty()) {
+            return false;
+        }
+
+        item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // Wake every waiter; pending items can still be popped
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    size_t getCapacity() const { return capacity_; }
+    size_t getHighWater() const { return high_water_; }
+    double getPushWaitSeconds() const { return push_wait_.count(); }
+    double getPopWaitSeconds() const { return pop_wait_.count(); }
+
+    // Mean depth right after a push (1.0 = the consumer keeps up)
+    double getMeanDepth() const { return pushes_ ? double(depth_sum_) / pushes_ : 0.0; }
+
+    // e.g. "2/2 high-water, mean depth 1.4"
+    std::string describe() const {
+        std::ostringstream oss;
+        oss.precision(2);
+        oss << high_water_ << "/" << capacity_ << " high-water, mean depth " << std::fixed
+            << getMeanDepth();
+        return oss.str();
+    }
+
+private:
+    size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+
+    size_t pushes_ = 0;
+    size_t depth_sum_ = 0;
+    size_t high_water_ = 0;
+    std::chrono::duration<double> push_wait_{0};
+    std::chrono::duration<double> pop_wait_{0};
+};
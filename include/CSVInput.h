@@ -33,6 +33,9 @@ public:
     // Parse ROV ASNs CSV
     // Format: asn (one per line, no header)
     static std::vector<uint32_t> parseROVASNs(const std::string& filename);
+
+    // Parse any one-ASN-per-line file; 'what' names it in messages
+    static std::vector<uint32_t> parseASNList(const std::string& filename, const std::string& what);
     
 private:
     // Helper to trim whitespace
@@ -1,8 +1,15 @@
 #pragma once
 
 #include "ASGraph.h"
+#include "RouteChange.h"
+#include <ostream>
 #include <string>
 #include <fstream>
+#include <unordered_map>
+#include <vector>
+
+// Simulated prefix -> every prefix that shares its routes (itself included)
+using PrefixAliases = std::unordered_map<std::string, std::vector<std::string>>;
 
 /**
  * CSV Output for routing tables
@@ -12,7 +19,38 @@ class CSVOutput {
 public:
     // Write routing table to CSV
     static bool writeRoutingTable(const ASGraph& graph, const std::string& filename);
+
+    // Write routing table, emitting each route once per aliased prefix
+    static bool writeRoutingTable(const ASGraph& graph, const std::string& filename,
+                                  const PrefixAliases& aliases);
+
+    // Same, restricted to the given ASes (written in ASN order)
+    static bool writeRoutingTable(const ASGraph& graph, const std::string& filename,
+                                  const PrefixAliases& aliases, const std::vector<uint32_t>& asns);
     
+    // Merge routing table files written by the functions above (each sorted
+    // by ASN, then prefix, with disjoint rows) into one file in the same order
+    static bool mergeRoutingTables(const std::vector<std::string>& parts, const std::string& filename);
+
+    // Append change,asn,prefix,old_path,new_path rows for one what-if change,
+    // fanning each route out to its aliased prefixes
+    static void writeRouteChanges(std::ostream& out, const std::string& label,
+                                  const std::vector<RouteChange>& changes,
+                                  const PrefixAliases& aliases);
+
+    // Write every AS's customer cone as "asn member member ..." lines, the
+    // AS itself first and then its customer cone in ASN order (the CAIDA
+    // ppdc-ases layout); requires graph.computeCustomerCones()
+    static bool writeCustomerCones(const ASGraph& graph, const std::string& filename);
+
+    // Append asn,prefix,rank,as_path rows of every kept alternate route
+    // (rank 1 is the best backup), sorted by ASN, then prefix, fanning each
+    // route out to its aliases; only the given ASes when asns is non-empty.
+    // Returns the number of routes (after fan-out) with at least one backup.
+    static size_t writeAlternateRoutes(std::ostream& out, const ASGraph& graph,
+                                       const PrefixAliases& aliases,
+                                       const std::vector<uint32_t>& asns = {});
+
     // Write single AS routing table to CSV
     static bool writeASRoutingTable(const AS& as, const std::string& filename);
     
@@ -22,4 +60,8 @@ public:
     private: //test
     // Format AS path as space-separated string
     static std::string formatASPath(const std::vector<uint32_t>& path);
+
+    // Write one AS's rows, materializing derived ASes and fanning out aliases
+    static void writeASRows(std::ostream& out, const ASGraph& graph, const AS& as,
+                            const PrefixAliases& aliases);
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Compressed set of 32-bit AS indices (roaring-style)
+ * Values are split by their high 16 bits into containers: a sorted array of
+ * low halves while a container holds few values, a 65536-bit bitmap once it
+ * holds more than kArrayLimit. Small cones stay a few bytes per member and
+ * the large cones near the top of the hierarchy cost at most 8 KB per 65536
+ * indices, with unions done container by container.
+ */
+class ConeSet {
+public:
+    void add(uint32_t value);
+    void unionWith(const ConeSet& other);
+    bool contains(uint32_t value) const;
+
+    size_t size() const { return cardinality_; }
+    bool empty() const { return cardinality_ == 0; }
+
+    // Members in ascending order
+    std::vector<uint32_t> toVector() const;
+
+    size_t getMemoryBytes() const;
+
+private:
+    static constexpr size_t kArrayLimit = 4096;  // Larger containers become bitmaps
+    static constexpr size_t kBitmapWords = 1024;
+
+    struct Container {
+        uint16_t key = 0;               // High 16 bits
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array;    // Sorted low halves, while small
+        std::vector<uint64_t> bitmap;   // kBitmapWords words, once large
+
+        bool isBitmap() const { return !bitmap.empty(); }
+        void toBitmap();
+    };
+
+    std::vector<Container> containers_;  // Sorted by key
+    size_t cardinality_ = 0;
+
+    static void unionContainer(Container& into, const Container& from);
+};
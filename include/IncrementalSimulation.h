@@ -0,0 +1,167 @@
+#pragma once
+
+#include "ASGraph.h"
+#include "CSVInput.h"
+#include "IndexedGraph.h"
+#include "ROV.h"
+#include "RouteChange.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Converged simulation kept resident for what-if questions
+ * Holds every prefix's routes as packed keys (see RouteKey.h) on a private
+ * IndexedGraph: the route after the up stage (what customers and peers
+ * hear) and the final route (what customers hear from their providers).
+ * Both are a fixed function of the neighbors' routes, so after one edge or
+ * ROV policy change only the ASes around the change are re-evaluated -
+ * customer routes in ascending rank order, final routes in descending
+ * order - and an AS's dependents are revisited only if its route or path
+ * changed. Invalidation therefore follows the next-hop subtrees hanging off
+ * the change. Same routes as RouteSolver (lowest-ASN tie-break).
+ */
+class IncrementalSimulation {
+public:
+    struct Change {
+        enum class Kind { REMOVE_LINK, ADD_PROVIDER_LINK, ADD_PEER_LINK, SET_ROV };
+        Kind kind;
+        uint32_t asn;    // Provider for ADD_PROVIDER_LINK; the AS for SET_ROV
+        uint32_t other;  // Second endpoint (unused for SET_ROV)
+        bool drop_invalid;
+
+        static Change removeLink(uint32_t a, uint32_t b) { return {Kind::REMOVE_LINK, a, b, false}; }
+        static Change addProviderLink(uint32_t provider, uint32_t customer) {
+            return {Kind::ADD_PROVIDER_LINK, provider, customer, false};
+        }
+        static Change addPeerLink(uint32_t a, uint32_t b) { return {Kind::ADD_PEER_LINK, a, b, false}; }
+        static Change setROV(uint32_t asn, bool drop) { return {Kind::SET_ROV, asn, 0, drop}; }
+
+        // Parse "remove-link A B", "add-provider-link P C", "add-peer-link A B",
+        // "rov-on A" or "rov-off A"
+        static std::optional<Change> parse(const std::string& line);
+        std::string describe() const;
+    };
+
+    using RouteChange = ::RouteChange;
+
+    // Directed link asn -> next_hop (its provider, peer or customer) and the
+    // number of (AS, prefix) final routes whose path crosses it
+    struct LinkLoad {
+        uint32_t asn;
+        uint32_t next_hop;
+        Relationship relationship;  // What next_hop is to asn
+        uint64_t routes;
+    };
+
+    // Solve every prefix of announcements on graph's topology, ROV flags and
+    // ROAs (requires computePropagationRanks()), on num_threads workers
+    IncrementalSimulation(const ASGraph& graph, const std::vector<InputAnnouncement>& announcements,
+                          size_t num_threads = 1);
+
+    // Whether change can be applied (known ASes, link present or absent as
+    // needed, and a new provider link closes no provider cycle; the ranks
+    // above it are raised as needed)
+    bool isApplicable(const Change& change) const;
+
+    // Routes that change, without touching the resident state. Safe to call
+    // from several threads at once.
+    std::vector<RouteChange> evaluate(const Change& change) const;
+
+    // Number of (AS, prefix) routes that change; skips building paths
+    size_t countChanges(const Change& change) const;
+
+    // Change in the number of routes leading to an invalid origin (negative:
+    // routes protected). Thread-safe like evaluate().
+    int64_t getInvalidRouteDelta(const Change& change) const;
+    size_t countInvalidRoutes() const;
+
+    // ASNs that do not drop invalid routes but hold one, final or up-stage,
+    // for some prefix: the only ASes whose ROV deployment can protect a route
+    std::vector<uint32_t> getInvalidRouteHolders() const;
+
+    // Route leak (RFC 7908 types 1 and 4): leaker also exports its route for
+    // prefix, learned from a provider or peer, to its providers and peers.
+    // Returns the number of other ASes whose route then runs through the
+    // leak; ASes already on the leaked path reject it (loop prevention).
+    // Thread-safe like evaluate().
+    size_t countLeakAdopters(uint32_t leaker, const std::string& prefix) const;
+
+    // ASNs holding a provider or peer route for prefix, i.e. with something to leak
+    std::vector<uint32_t> getLeakCandidates(const std::string& prefix) const;
+
+    // Transit load of every link some route crosses, sorted by (asn, next_hop).
+    // Counted with NextHopTreeLoad, the counter behind --transit-load.
+    std::vector<LinkLoad> getLinkLoads(size_t num_threads = 1) const;
+
+    // Apply change for good; returns the routes that changed
+    std::vector<RouteChange> apply(const Change& change);
+
+    size_t getPrefixCount() const { return prefixes_.size(); }
+
+    // Re-solve every prefix from scratch with RouteSolver on the current
+    // topology and ROV flags; returns the number of (AS, prefix) routes that
+    // differ from the resident ones (0 if apply() kept them exact)
+    size_t verify(size_t num_threads = 1) const;
+
+    // Install the current routes into graph (the ASGraph this was built from)
+    void installRoutes(ASGraph& graph) const;
+
+private:
+    struct PrefixState {
+        std::string prefix;
+        std::vector<InputAnnouncement> announcements;    // As given, for verify()
+        std::unordered_map<uint32_t, uint64_t> origins;  // AS index -> origin route key
+        bool contested = false;                          // Some origin is ROV-invalid
+        std::vector<uint64_t> up;                        // Customer/origin route, per AS
+        std::vector<uint64_t> best;                      // Final route, per AS
+    };
+
+    // New keys of the ASes a change touched, for one prefix
+    struct PrefixDelta {
+        std::unordered_map<uint32_t, uint64_t> up;
+        std::unordered_map<uint32_t, uint64_t> best;
+        std::vector<uint32_t> changed;  // ASes whose final route is marked (see sweepPrefix)
+    };
+
+    // Export beyond valley-free for one sweep (RFC 7908 types 1 and 4):
+    // leaker also sends its final route, leaked_key, to its providers and
+    // peers, and the ASes in rejecting (its path) drop routes through it
+    struct ExportRule {
+        uint32_t leaker = IndexedGraph::kNoIndex;
+        uint64_t leaked_key = 0;
+        const std::unordered_set<uint32_t>* rejecting = nullptr;
+    };
+
+    class View;
+
+    IndexedGraph graph_;
+    ROVValidator validator_;
+    std::vector<PrefixState> prefixes_;
+    std::unordered_map<std::string, size_t> prefix_index_;
+
+    void solve(PrefixState& state) const;
+    PrefixDelta evaluatePrefix(const PrefixState& state, const View& view,
+                               const std::vector<uint32_t>& seeds) const;
+    // Re-evaluate the ASes reachable from the seeds under rule: up-stage
+    // routes in ascending rank order, then final routes in descending order.
+    // An AS's dependents are revisited only if its key changed or its route
+    // is marked: with a leaker, marked routes run through the leak;
+    // without one, every changed route or path is marked.
+    PrefixDelta sweepPrefix(const PrefixState& state, const View& view,
+                            const std::vector<uint32_t>& up_seeds,
+                            const std::vector<uint32_t>& best_seeds, const ExportRule& rule) const;
+    // ROV flags only matter where some origin is invalid
+    static bool isAffected(const PrefixState& state, const Change& change) {
+        return state.contested || change.kind != Change::Kind::SET_ROV;
+    }
+    std::vector<uint32_t> getSeeds(const Change& change) const;
+    bool applyToGraph(const Change& change);
+
+    std::vector<uint32_t> buildPath(const PrefixState& state, const PrefixDelta* delta,
+                                    uint32_t index) const;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ASGraph.h"
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * IndexedGraph - dense snapshot of an ASGraph for array-based engines
+ * ASes are numbered 0..N-1 in ascending ASN order, so comparing indices
+ * orders neighbors exactly like comparing ASNs. Neighbor lists are sorted.
+ * Holds no routing state; engines keep their own per-index arrays.
+ */
+class IndexedGraph {
+public:
+    static constexpr uint32_t kNoIndex = UINT32_MAX;
+
+    // Snapshot topology, ranks and ROV flags (requires computePropagationRanks())
+    explicit IndexedGraph(const ASGraph& graph);
+
+    size_t size() const { return asns_.size(); }
+    uint32_t getASN(uint32_t index) const { return asns_[index]; }
+    uint32_t getIndex(uint32_t asn) const;  // kNoIndex if the ASN is unknown
+
+    const std::vector<uint32_t>& getProviders(uint32_t index) const { return providers_[index]; }
+    const std::vector<uint32_t>& getCustomers(uint32_t index) const { return customers_[index]; }
+    const std::vector<uint32_t>& getPeers(uint32_t index) const { return peers_[index]; }
+
+    // Propagation ranks (same grouping as ASGraph::getPropagationRanks())
+    int getRank(uint32_t index) const { return rank_[index]; }
+    const std::vector<std::vector<uint32_t>>& getRanks() const { return ranks_; }
+
+    // ROV policy per AS
+    bool getDropInvalid(uint32_t index) const { return drop_invalid_[index] != 0; }
+    void setDropInvalid(uint32_t index, bool drop) { drop_invalid_[index] = drop ? 1 : 0; }
+    const std::vector<uint8_t>& getDropInvalidFlags() const { return drop_invalid_; }
+
+    // Ranks a new provider -> customer link needs: the provider and those
+    // of its providers that must move up to stay above their customers,
+    // with their new ranks (empty if the ranks already fit). nullopt if the
+    // link would close a provider cycle.
+    std::optional<std::vector<std::pair<uint32_t, int>>> getRaisedRanks(uint32_t provider,
+                                                                        uint32_t customer) const;
+
+    // Topology edits for what-if analysis. A new provider link raises the
+    // ranks above it as getRaisedRanks() says; removing a link keeps them,
+    // as they still order every customer below its providers. False if the
+    // link is missing (remove), present, or would close a cycle (add).
+    bool removeLink(uint32_t a, uint32_t b);
+    bool addProviderLink(uint32_t provider, uint32_t customer);
+    bool addPeerLink(uint32_t a, uint32_t b);
+    bool hasLink(uint32_t a, uint32_t b) const;
+
+private:
+    std::vector<uint32_t> asns_;
+    std::unordered_map<uint32_t, uint32_t> index_;
+    std::vector<std::vector<uint32_t>> providers_;
+    std::vector<std::vector<uint32_t>> customers_;
+    std::vector<std::vector<uint32_t>> peers_;
+    std::vector<int> rank_;
+    std::vector<std::vector<uint32_t>> ranks_;
+    std::vector<uint8_t> drop_invalid_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "IncrementalSimulation.h"
+#include "Scheduler.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Link-failure sensitivity: how many (AS, prefix) routes change when one
+ * inter-AS link fails
+ * Links are picked by the transit load of the converged baseline (routes
+ * crossing them in either direction, IncrementalSimulation::getLinkLoads).
+ * Each failure is evaluated on its own from that baseline
+ * (IncrementalSimulation::countChanges), so only the next-hop subtrees
+ * hanging off the link are recomputed; failures are spread over the workers.
+ * A link no route crosses cannot change any route, so it is never a candidate.
+ */
+class LinkFailureSweep {
+public:
+    struct Link {
+        uint32_t a;        // Provider of a provider-customer link, else the lower ASN
+        uint32_t b;
+        bool peer;
+        uint64_t load;     // Routes crossing the link
+        size_t changed = 0;  // Routes that change when it fails
+    };
+
+    LinkFailureSweep(const IncrementalSimulation& simulation, size_t num_threads);
+
+    // The k links with the highest transit load (every loaded link if k is 0)
+    std::vector<Link> selectLinks(size_t k) const;
+
+    // Fail each link in turn; returns them most critical first (ties: load)
+    std::vector<Link> run(std::vector<Link> links);
+
+    // rank,asn_a,asn_b,link,transit_load,changed_routes
+    static bool writeCSV(const std::string& filename, const std::vector<Link>& links);
+
+private:
+    const IncrementalSimulation& simulation_;
+    WorkStealingExecutor executor_;
+};
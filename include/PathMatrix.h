@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Memory-mapped all-origins next-hop matrix
+ * For every origin, the next hop (a dense AS index) of every AS's best
+ * route toward it: 4 bytes per (source, origin) instead of a path. An AS's
+ * neighbors always hear its own best route toward a single origin, so
+ * following next hops from any source rebuilds its AS path.
+ *
+ * File layout (native byte order, every field a uint32 after the magic):
+ *   "ASPATHM1", num_ases, num_origins,
+ *   asns[num_ases]            (dense index -> ASN, ascending)
+ *   origins[num_origins]      (dense indices)
+ *   hops[num_origins][num_ases] (kNoRoute, or the next hop; origins hold themselves)
+ * Each origin's column is contiguous, so workers fill disjoint ranges of
+ * the mapping and the kernel writes pages back as it sees fit.
+ */
+class PathMatrix {
+public:
+    static constexpr uint32_t kNoRoute = UINT32_MAX;
+
+    PathMatrix() = default;
+    PathMatrix(const PathMatrix&) = delete;
+    PathMatrix& operator=(const PathMatrix&) = delete;
+    ~PathMatrix();
+
+    // Create (or truncate) filename sized for asns x origins, mapped read-write
+    bool create(const std::string& filename, const std::vector<uint32_t>& asns,
+                const std::vector<uint32_t>& origins);
+
+    // Map an existing matrix read-only
+    bool open(const std::string& filename);
+
+    // Flush and unmap; false if the flush failed
+    bool close();
+
+    size_t getASCount() const { return num_ases_; }
+    size_t getOriginCount() const { return num_origins_; }
+    uint32_t getOrigin(size_t slot) const { return origins_[slot]; }
+
+    // Next hops toward the origin in slot, one per AS index (writable after create())
+    uint32_t* getColumn(size_t slot) { return hops_ + slot * num_ases_; }
+
+    // AS path from source toward origin, both ASNs, source first; empty if
+    // source has no route or origin is not in the matrix
+    std::vector<uint32_t> getPath(uint32_t source, uint32_t origin) const;
+
+private:
+    int fd_ = -1;
+    void* data_ = nullptr;
+    size_t bytes_ = 0;
+
+    size_t num_ases_ = 0;
+    size_t num_origins_ = 0;
+    const uint32_t* asns_ = nullptr;
+    const uint32_t* origins_ = nullptr;
+    uint32_t* hops_ = nullptr;
+    std::unordered_map<uint32_t, uint32_t> index_;  // ASN -> dense index
+    std::unordered_map<uint32_t, size_t> slots_;    // Origin index -> column
+
+    bool map(bool writable);
+    void buildIndex();
+};
@@ -23,8 +23,46 @@ public:
      * - Export everything to customers
      * - Export customer routes to peers and providers
      * - Don't export peer/provider routes to peers/providers
+     * unless the AS leaks (RFC 7908 types 1 and 4), in which case it also
+     * exports peer/provider routes to its peers and providers.
+     * Defined inline so kernels calling it with a constant exportTo fold it away.
      */
-    static bool shouldExport(Relationship learnedFrom, Relationship exportTo);
+    static constexpr bool shouldExport(Relationship learnedFrom, Relationship exportTo,
+                                       bool leaks = false) {
+        // Always export originated routes
+        if (learnedFrom == Relationship::ORIGIN) {
+            return true;
+        }
+
+        // Always export to customers (they pay us)
+        if (exportTo == Relationship::CUSTOMER) {
+            return true;
+        }
+
+        // Export customer routes to peers and providers
+        if (learnedFrom == Relationship::CUSTOMER) {
+            return true;
+        }
+
+        // A leaking AS exports everything everywhere
+        if (leaks) {
+            return true;
+        }
+
+        // Don't export peer routes to other peers or providers (valley-free)
+        if (learnedFrom == Relationship::PEER &&
+            (exportTo == Relationship::PEER || exportTo == Relationship::PROVIDER)) {
+            return false;
+        }
+
+        // Don't export provider routes to peers or other providers (valley-free)
+        if (learnedFrom == Relationship::PROVIDER &&
+            (exportTo == Relationship::PEER || exportTo == Relationship::PROVIDER)) {
+            return false;
+        }
+
+        return true;
+    }
     
     /**
      * Get local preference for a relationship
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "IndexedGraph.h"
+#include "ROV.h"
+#include "Scheduler.h"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Prefix-vectorized propagation engine
+ * Runs the up/peer/down phases for a block of 8, 16 or 32 prefixes in
+ * lockstep. Every AS holds one lane per prefix: a packed route key (same
+ * layout as BestPathSelector: ROV rank, local pref, path length, neighbor)
+ * and a next hop. Export filtering and best-path selection are lane-wise
+ * compares and selects over the whole block, so one walk over the graph
+ * serves W prefixes. The lane updates use AVX2 (four lanes per register)
+ * when the CPU supports it, checked once at startup, and a scalar loop
+ * otherwise.
+ *
+ * Produces the same RIBs as ASGraph::propagateToConvergence(): each phase
+ * is a single rank-ordered sweep, which is exactly the engine's first round
+ * (later rounds never change a route).
+ */
+class PrefixBlockEngine {
+public:
+    static bool isSupportedWidth(size_t width) { return width == 8 || width == 16 || width == 32; }
+
+    PrefixBlockEngine(const IndexedGraph& graph, const ROVValidator& validator, size_t block_width);
+
+    size_t getBlockWidth() const { return width_; }
+
+    // "avx2" or "scalar"
+    static const char* getKernelName();
+
+    // Simulate up to block_width prefixes (one task per lane) and install the
+    // resulting routes into graph, the ASGraph the IndexedGraph was built from.
+    // install_mutex (optional) guards the installation. Returns seeded announcements.
+    size_t runBlock(const PrefixTask* tasks, size_t count, ASGraph& graph,
+                    std::mutex* install_mutex = nullptr);
+
+private:
+    const IndexedGraph& graph_;
+    const ROVValidator& validator_;
+    size_t width_;
+
+    // Lane arrays, indexed [as_index * width_ + lane]
+    std::vector<uint64_t> key_;        // Current best route (0 = no route)
+    std::vector<uint32_t> next_hop_;   // Neighbor the route came from (self for origins)
+    std::vector<uint64_t> key_up_;     // Snapshot after the up phase (exported to peers)
+    std::vector<uint32_t> next_hop_up_;
+
+    template <size_t W> void propagateBlock();
+
+    // Rebuild the AS path of (index, lane) from the next-hop arrays
+    void buildPath(uint32_t index, size_t lane, std::vector<uint32_t>& path) const;
+};
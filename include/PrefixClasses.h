@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CSVInput.h"
+#include "CSVOutput.h"
+#include "ROV.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * Prefixes grouped into origin-equivalence classes
+ * Two prefixes announced by the same origins (in the same order) with the
+ * same ROV state per origin propagate identically - only the prefix string
+ * differs. Each class is simulated once through its first prefix, and the
+ * resulting routes are fanned out to every member when writing the RIBs.
+ */
+struct PrefixClasses {
+    std::vector<InputAnnouncement> announcements;  // Announcements of each class's representative
+    PrefixAliases aliases;                         // Representative -> member prefixes (itself included)
+    size_t num_prefixes = 0;
+
+    size_t getClassCount() const { return aliases.size(); }
+
+    // Group announcements; ROAs must already be loaded into the validator
+    static PrefixClasses group(const std::vector<InputAnnouncement>& announcements,
+                               const ROVValidator& validator);
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * Final tie-break of the BGP decision process once ROV state,
+ * local preference and AS path length are equal
+ */
+enum class TieBreak {
+    LOWEST_NEIGHBOR_ASN,  // BGPy: prefer the route from the lowest neighbor ASN
+    OLDEST_PATH           // Keep the route that was received first
+};
+
+/**
+ * Compile-time feature set for the propagation kernel
+ * Each combination is a separate instantiation of the AS/ASGraph
+ * propagation templates, so disabled features cost nothing per route.
+ *
+ * ROV: validate routes and apply drop_invalid_/ROV-state preference
+ * Communities: honour NO_EXPORT / NO_ADVERTISE when exporting
+ */
+template <bool UseROV, bool UseCommunities, TieBreak Rule>
+struct PropagationFeatures {
+    static constexpr bool kROV = UseROV;
+    static constexpr bool kCommunities = UseCommunities;
+    static constexpr TieBreak kTieBreak = Rule;
+};
+
+// Everything enabled - what the non-template AS methods use
+using DefaultPropagationFeatures = PropagationFeatures<true, true, TieBreak::LOWEST_NEIGHBOR_ASN>;
+
+/**
+ * Runtime selection of a feature set (dispatched once per run)
+ */
+struct PropagationOptions {
+    bool rov = true;
+    bool communities = true;
+    TieBreak tie_break = TieBreak::LOWEST_NEIGHBOR_ASN;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "ASGraph.h"
+#include "CSVInput.h"
+#include "IndexedGraph.h"
+#include "PrefixBlock.h"
+#include "PropagationFeatures.h"
+#include "RouteSolver.h"
+#include "Scheduler.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Runs one of the propagation engines over batches of announcements
+ *   inbox  - AS inbox machinery (ASGraph::propagateToConvergence), on worker
+ *            replicas of the topology when num_threads > 1
+ *   vector - PrefixBlockEngine, block_size prefixes per sweep
+ *   bfs    - RouteSolver, one prefix at a time
+ * Engine state (index snapshot, solvers, replicas) is built once, against
+ * the graph's current topology and active ASes, and reused by every batch.
+ * A batch's routes are installed into the graph's RIBs; callers clear them
+ * with ASGraph::clearRoutingTables() before the next batch.
+ */
+class PropagationRunner {
+public:
+    static bool isKnownEngine(const std::string& engine);
+
+    PropagationRunner(ASGraph& graph, const std::string& engine, const PropagationOptions& options,
+                      size_t num_threads, size_t block_size);
+
+    // Seed and propagate one batch. Prefixes must not be split across
+    // batches. Returns the number of seeded announcements.
+    size_t run(const std::vector<InputAnnouncement>& announcements);
+
+    // Memory model behind --max-memory. An installed route is the routing
+    // table node (prefix key, Announcement, next pointer and cached hash)
+    // plus its malloc header, a bucket slot, and the AS path's heap block,
+    // which malloc's smallest 32-byte chunk covers for paths up to 6 hops.
+    // That gives 232 bytes on libstdc++/glibc x86-64, against a measured
+    // slope of about 220. The other figures are calibrated on the CAIDA
+    // bench topology (78,638 ASes, --no-prefix-classes) as the slope of peak
+    // RSS between --batch-size 8 and 32, divided by the ASes and added
+    // prefixes. Routes of a batch, per (AS, prefix):
+    static constexpr size_t kMallocChunkHeader = 16;     // glibc chunk header, rounded to its alignment
+    static constexpr size_t kMinPathBlock = 32;          // Smallest malloc chunk, holds 6 hops
+    static constexpr size_t kInstalledRouteBytes =       // Installed route (Announcement, AS path, hash map node)
+        sizeof(std::pair<const std::string, Announcement>) + 2 * sizeof(void*) + kMallocChunkHeader +
+        sizeof(void*) + kMinPathBlock;
+    static constexpr size_t kInboxRouteBytes = 900;      // Single-graph inbox: installed route plus the
+                                                         // queued copies of every prefix in flight
+    // Scratch per AS that does not grow with the batch:
+    static constexpr size_t kReplicaScratchBytes = 700;  // Per inbox replica: copies for its prefix in flight
+    static constexpr size_t kBlockScratchBytes = 250;    // Per vector worker and lane: the block's routes
+                                                         // materialized before they are installed
+
+    // Approximate peak memory per installed route of a batch, and per AS for
+    // the scratch the workers hold regardless of the batch size
+    size_t getBytesPerRoute() const;
+    size_t getScratchBytesPerAS() const;
+
+    // Human-readable engine description for progress output
+    std::string describe() const;
+
+    // Most rounds any inbox propagation needed (0 for the array engines)
+    int getMaxRounds() const { return max_rounds_; }
+    size_t getWorkerCount() const { return num_threads_; }
+
+    // Worker statistics accumulated over all batches
+    const WorkStealingExecutor& getExecutor() const { return executor_; }
+
+private:
+    ASGraph& graph_;
+    std::string engine_;
+    PropagationOptions options_;
+    size_t num_threads_;
+    size_t block_size_;
+    int max_rounds_;
+
+    std::unique_ptr<IndexedGraph> indexed_;
+    std::vector<std::unique_ptr<PrefixBlockEngine>> block_engines_;
+    std::vector<std::unique_ptr<RouteSolver>> solvers_;
+    std::vector<std::unique_ptr<ASGraph>> replicas_;
+    WorkStealingExecutor executor_;
+    std::mutex install_mutex_;
+
+    size_t runVector(std::vector<PrefixTask>& tasks);
+    size_t runSolver(std::vector<PrefixTask>& tasks);
+    size_t runInbox(const std::vector<InputAnnouncement>& announcements);
+    size_t runInboxReplicas(std::vector<PrefixTask>& tasks);
+};
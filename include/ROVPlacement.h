@@ -0,0 +1,46 @@
+#pragma once
+
+#include "IncrementalSimulation.h"
+#include "Scheduler.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Greedy ROV placement: the k ASes whose ROV deployment protects the most
+ * routes, on top of the ASes that already filter
+ * A candidate's marginal gain is the number of (AS, prefix) routes that
+ * stop leading to an invalid origin when it starts dropping invalid routes,
+ * evaluated incrementally (IncrementalSimulation::getInvalidRouteDelta).
+ * Lazy greedy (CELF): gains are kept in a max-heap and only the top entry is
+ * re-evaluated after each pick; a candidate whose fresh gain still tops the
+ * heap is picked without touching the rest. Stale entries at the top are
+ * re-evaluated in parallel, one batch per round.
+ */
+class ROVPlacement {
+public:
+    struct Pick {
+        uint32_t asn;
+        int64_t gain;             // Routes protected by this pick
+        size_t invalid_after;     // Routes still leading to an invalid origin
+        size_t evaluations;       // Gain evaluations so far
+    };
+
+    ROVPlacement(IncrementalSimulation& simulation, size_t num_threads);
+
+    // Pick up to k candidates (fewer if no candidate protects anything);
+    // each pick is applied to the simulation
+    std::vector<Pick> run(const std::vector<uint32_t>& candidates, size_t k);
+
+    size_t getEvaluationCount() const { return evaluations_; }
+
+    static bool writeCSV(const std::string& filename, const std::vector<Pick>& picks);
+
+private:
+    IncrementalSimulation& simulation_;
+    WorkStealingExecutor executor_;
+    size_t evaluations_ = 0;
+
+    std::vector<int64_t> evaluate(const std::vector<uint32_t>& asns);
+};
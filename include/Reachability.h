@@ -0,0 +1,51 @@
+#pragma once
+
+#include "IndexedGraph.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * Bit-parallel reachability under valley-free export
+ * Answers "does AS X have a route to origin Y, and of which class?"
+ * without building paths. One pass handles up to 64 origins: bit i of an
+ * AS's masks stands for origins[i], and the three Gao-Rexford stages become
+ * bitwise ORs over the rank order of the provider DAG:
+ *
+ *   customer[v] = origin bits of v | OR customer[c] over customers c
+ *   peer[v]     = OR customer[u] over peers u, minus customer[v]
+ *   provider[v] = OR (customer|peer|provider)[p] over providers p, minus the above
+ *
+ * The masks are disjoint and hold each AS's best route class (customer >
+ * peer > provider), matching the route the full simulation would select.
+ * ROV is not modelled - this is pure Gao-Rexford reachability.
+ */
+class ReachabilityEngine {
+public:
+    static constexpr size_t kOriginsPerPass = 64;
+
+    explicit ReachabilityEngine(const IndexedGraph& graph);
+
+    // Compute one pass for up to 64 origins (dense indices)
+    void runPass(const uint32_t* origins, size_t count);
+
+    // Class masks of the last pass; bit i refers to origins[i]
+    uint64_t getCustomerMask(uint32_t index) const { return customer_[index]; }
+    uint64_t getPeerMask(uint32_t index) const { return peer_[index]; }
+    uint64_t getProviderMask(uint32_t index) const { return provider_[index]; }
+
+    // Per-origin counts of ASes reaching it through each class
+    // CSV: origin,customer,peer,provider,unreachable
+    void writeSummaryRows(std::ostream& out) const;
+
+    // One row per (AS, origin) with a route, origin itself included
+    // CSV: asn,origin,relationship (origin|customer|peer|provider)
+    void writeMatrixRows(std::ostream& out) const;
+
+private:
+    const IndexedGraph& graph_;
+    std::vector<uint32_t> origins_;
+    std::vector<uint64_t> customer_;
+    std::vector<uint64_t> peer_;
+    std::vector<uint64_t> provider_;
+};
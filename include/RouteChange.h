@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * One RIB entry that a what-if change altered (see IncrementalSimulation)
+ * An empty path means no route.
+ */
+struct RouteChange {
+    uint32_t asn;
+    std::string prefix;
+    std::vector<uint32_t> old_path;
+    std::vector<uint32_t> new_path;
+};
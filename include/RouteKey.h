@@ -0,0 +1,96 @@
+#pragma once
+
+#include "BestPath.h"
+#include "IndexedGraph.h"
+#include "Policy.h"
+#include "ROV.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Helpers for routes held as packed keys (layout in BestPath.h)
+ * Used by the array-based engines, which store one key per AS instead of
+ * an Announcement and rebuild the announcement only at install time.
+ */
+namespace RouteKey {
+
+// Field masks of the packed key
+constexpr uint64_t kRankMask = 0x3ULL << 62;
+constexpr uint64_t kPrefMask = 0x3FFFULL << 48;
+constexpr uint64_t kLengthMask = 0xFFFFULL << 32;
+constexpr uint64_t kLengthUnit = 1ULL << 32;
+
+inline uint64_t prefField(Relationship rel) {
+    return static_cast<uint64_t>(Policy::getLocalPreference(rel)) << 48;
+}
+
+inline uint8_t rovRank(ROVState state) {
+    return state == ROVState::VALID ? 2 : (state == ROVState::UNKNOWN ? 1 : 0);
+}
+
+inline ROVState getROVState(uint64_t key) {
+    switch (key >> 62) {
+        case 2: return ROVState::VALID;
+        case 1: return ROVState::UNKNOWN;
+        default: return ROVState::INVALID;
+    }
+}
+
+inline Relationship getRelationship(uint64_t key) {
+    uint64_t pref = key & kPrefMask;
+    if (pref == prefField(Relationship::ORIGIN)) return Relationship::ORIGIN;
+    if (pref == prefField(Relationship::CUSTOMER)) return Relationship::CUSTOMER;
+    if (pref == prefField(Relationship::PEER)) return Relationship::PEER;
+    return Relationship::PROVIDER;
+}
+
+// Route the AS originated itself; ROV never replaces it with a learned one
+inline bool isOrigin(uint64_t key) {
+    return (key & kPrefMask) == prefField(Relationship::ORIGIN);
+}
+
+inline uint32_t getPathLength(uint64_t key) {
+    return BestPathSelector::kMaxPathLength - static_cast<uint32_t>((key & kLengthMask) >> 32);
+}
+
+// Key of a route originated by the AS with the given dense index
+inline uint64_t origin(ROVState state, uint32_t index) {
+    return BestPathSelector::packKey(rovRank(state),
+        static_cast<uint16_t>(Policy::getLocalPreference(Relationship::ORIGIN)), 1, ~index);
+}
+
+// Key of route learned over a pref_field edge from neighbor 'from'
+inline uint64_t extend(uint64_t route, uint64_t pref_field, uint32_t from) {
+    return (route & kRankMask) | pref_field | ((route & kLengthMask) - kLengthUnit) |
+           static_cast<uint32_t>(~from);
+}
+
+// Comparison mask: ASes without ROV ignore the ROV rank (see AS::isBetterPath)
+inline uint64_t compareMask(bool drop_invalid) {
+    return drop_invalid ? ~0ULL : ~kRankMask;
+}
+
+// Append the AS path of index's route, rebuilt from an engine's arrays.
+// final_route(v) and up_route(v) return the (key, next hop) of v's final
+// route and of its route after the up stage. Provider routes extend the
+// provider's final route; customer and peer routes extend the neighbor's
+// up-stage route, the one it exported to them.
+template <typename FinalRoute, typename UpRoute>
+void buildPath(const IndexedGraph& graph, uint32_t index, FinalRoute final_route, UpRoute up_route,
+               std::vector<uint32_t>& path) {
+    std::pair<uint64_t, uint32_t> route = final_route(index);
+    bool up = false;
+    while (true) {
+        path.push_back(graph.getASN(index));
+        Relationship rel = getRelationship(route.first);
+        if (rel == Relationship::ORIGIN) {
+            return;
+        }
+        up = up || rel != Relationship::PROVIDER;
+        index = route.second;
+        route = up ? up_route(index) : final_route(index);
+    }
+}
+
+}  // namespace RouteKey
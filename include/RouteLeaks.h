@@ -0,0 +1,38 @@
+#pragma once
+
+#include "IncrementalSimulation.h"
+#include "Scheduler.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Route-leak impact per leaker against one victim prefix
+ * Every AS exports valley-free (Policy::shouldExport) except the leaker of
+ * the scenario at hand, which also sends its provider or peer route for the
+ * victim prefix to its providers and peers. Each leaker is evaluated on its
+ * own against the converged baseline (IncrementalSimulation::countLeakAdopters),
+ * so only the ASes the leak reaches are recomputed; leakers are spread over
+ * the workers.
+ */
+class RouteLeaks {
+public:
+    struct Result {
+        uint32_t leaker;
+        size_t adopters;  // Other ASes whose route runs through the leak
+    };
+
+    RouteLeaks(const IncrementalSimulation& simulation, size_t num_threads);
+
+    // One result per leaker, most adopters first (ties: lowest ASN)
+    std::vector<Result> run(const std::string& prefix, const std::vector<uint32_t>& leakers);
+
+    // prefix,leaker,adopting_ases,adoption_share; the share is over the other ASes
+    static bool writeCSV(const std::string& filename, const std::string& prefix,
+                         const std::vector<Result>& results, size_t as_count);
+
+private:
+    const IncrementalSimulation& simulation_;
+    WorkStealingExecutor executor_;
+};
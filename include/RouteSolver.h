@@ -0,0 +1,72 @@
+#pragma once
+
+#include "IndexedGraph.h"
+#include "ROV.h"
+#include "Scheduler.h"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Three-stage route solver for one prefix at a time
+ * Computes Gao-Rexford best routes with the lowest-neighbor-ASN tie-break
+ * directly on an IndexedGraph, without the AS inbox machinery:
+ *
+ *   1. up:   customer -> provider search from the origins
+ *   2. peer: one hop from every AS holding a customer/origin route
+ *   3. down: provider -> customer search from every AS holding a route
+ *
+ * Each search only visits ASes it reaches, in rank order (ascending up,
+ * descending down), so every AS forwards its final route exactly once and
+ * a prefix costs O(edges touched). The RIBs match propagateToConvergence().
+ */
+class RouteSolver {
+public:
+    RouteSolver(const IndexedGraph& graph, const ROVValidator& validator);
+
+    // Same, with a per-index ROV policy in place of the graph's flags, so
+    // solvers with different ROV sets can share one IndexedGraph
+    RouteSolver(const IndexedGraph& graph, const ROVValidator& validator,
+                const std::vector<uint8_t>& drop_invalid);
+
+    // Solve one prefix and install its routes into graph, the ASGraph the
+    // IndexedGraph was built from. install_mutex (optional) guards the
+    // installation. Returns the number of seeded announcements.
+    size_t solve(const PrefixTask& task, ASGraph& graph, std::mutex* install_mutex = nullptr);
+
+    // Solve one prefix without building paths or installing anything; the
+    // routes stay readable through the accessors below until the next call
+    size_t compute(const PrefixTask& task);
+
+    // ASes holding a route after the last solve()/compute()
+    size_t getReachedCount() const { return touched_.size(); }
+    const std::vector<uint32_t>& getReached() const { return touched_; }
+    uint64_t getKey(uint32_t index) const { return key_[index]; }
+
+private:
+    const IndexedGraph& graph_;
+    const ROVValidator& validator_;
+    const uint8_t* drop_invalid_;  // Per-index ROV policy
+
+    // Per-AS state, indexed by dense AS index; only touched_ entries are non-zero
+    std::vector<uint64_t> key_;      // Best route as a packed key (0 = no route)
+    std::vector<uint32_t> hop_;      // Neighbor the route came from (self for origins)
+    std::vector<uint64_t> up_key_;   // Route after the up stage (what peers see)
+    std::vector<uint32_t> up_hop_;
+    std::vector<uint8_t> queued_;
+    std::vector<uint32_t> touched_;
+
+    // Frontier, bucketed by propagation rank
+    std::vector<std::vector<uint32_t>> buckets_;
+
+    // Offer a route learned from 'from' to AS 'to'; true if it was taken
+    bool relax(uint32_t to, uint64_t candidate, uint32_t from);
+    void enqueue(uint32_t index);
+
+    void upStage();
+    void peerStage(size_t up_count);
+    void downStage();
+    void reset();
+
+    void buildPath(uint32_t index, std::vector<uint32_t>& path) const;
+};
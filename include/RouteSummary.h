@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ASGraph.h"
+#include "CSVOutput.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Per-prefix, per-origin route counts in place of full RIB dumps
+ * Counts the ASes whose route leads to each origin, split by whether the
+ * AS drops invalid routes and by the relationship the route was learned
+ * over. Only the origin and relationship fields of installed routes are
+ * read; no path is ever formatted. Batches add up, as their prefixes are
+ * disjoint.
+ */
+class RouteSummary {
+public:
+    // Count the routes graph currently holds; only the given ASes when
+    // asns is non-empty
+    void add(const ASGraph& graph, const std::vector<uint32_t>& asns = {});
+
+    // prefix,origin,ases,origin_ases,rov_ases,non_rov_ases, then rov_/non_rov_
+    // counts via customer, peer and provider routes; sorted by prefix, then
+    // origin, with each simulated prefix fanned out to its aliases. ases is
+    // origin_ases (the origin's own route) plus the learned routes.
+    bool writeCSV(const std::string& filename, const PrefixAliases& aliases) const;
+
+private:
+    struct Counts {
+        uint32_t origin;
+        size_t ases[2][4] = {};  // [drops invalid][Relationship]
+    };
+
+    std::unordered_map<std::string, std::vector<Counts>> counts_;  // Simulated prefix -> origins
+
+    void addTable(const std::unordered_map<std::string, Announcement>& table, bool rov);
+};
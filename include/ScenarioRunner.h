@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ASGraph.h"
+#include "IndexedGraph.h"
+#include "Scheduler.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Runs many scenarios against one topology
+ * The graph is loaded once and frozen into a const IndexedGraph that every
+ * worker reads without locking. Everything a scenario varies is owned by
+ * the scenario: its announcements and ROAs, ROV flags, solver scratch and
+ * RIBs. Scenarios run concurrently, one per worker, with the three-stage
+ * route solver (lowest-ASN tie-break), and each writes its own RIB file.
+ */
+class ScenarioRunner {
+public:
+    struct Scenario {
+        std::string name;
+        std::string announcements_file;
+        std::string rov_asns_file;  // Empty: no AS drops invalid routes
+        std::string output_file;
+    };
+
+    struct Result {
+        bool ok = false;
+        size_t prefixes = 0;
+        size_t seeded = 0;
+        double seconds = 0.0;
+    };
+
+    // Parse "name,announcements[,rov_asns]" lines ('#' starts a comment).
+    // Relative paths are resolved against the manifest's directory; output
+    // files are left for the caller to name.
+    static std::vector<Scenario> parseManifest(const std::string& filename);
+
+    // Check scenarios before any of them runs: names and output files
+    // unique, input files readable. Reports every problem; false if any.
+    static bool validate(const std::vector<Scenario>& scenarios);
+
+    // graph must have its propagation ranks computed
+    ScenarioRunner(const ASGraph& graph, size_t num_threads);
+
+    // Run every scenario; false if any of them failed
+    bool run(const std::vector<Scenario>& scenarios);
+
+    // Per scenario, in manifest order, after run()
+    const std::vector<Result>& getResults() const { return results_; }
+    const WorkStealingExecutor& getExecutor() const { return executor_; }
+
+private:
+    const IndexedGraph topology_;
+    std::vector<std::unique_ptr<ASGraph>> ribs_;  // One RIB buffer per worker
+    WorkStealingExecutor executor_;
+    std::vector<Result> results_;
+
+    Result runScenario(const Scenario& scenario, ASGraph& ribs) const;
+};
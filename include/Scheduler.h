@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ASGraph.h"
+#include "CSVInput.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * A unit of simulation work: every announcement for one prefix.
+ * Prefixes never interact during propagation, so tasks are independent.
+ */
+struct PrefixTask {
+    std::string prefix;
+    std::vector<InputAnnouncement> announcements;
+    double cost = 0.0;  // Estimated relative cost (see PrefixCostModel)
+};
+
+/**
+ * Per-prefix cost estimate
+ * Work grows with the size of the origins' customer cones and with the
+ * number of competing origins (hijacks, ROV-invalid announcements).
+ */
+class PrefixCostModel {
+public:
+    // Group announcements into one task per prefix (first-seen order)
+    static std::vector<PrefixTask> buildTasks(const std::vector<InputAnnouncement>& announcements);
+
+    // Estimate the cost of a task against the given topology
+    static double estimate(const ASGraph& graph, const PrefixTask& task);
+};
+
+/**
+ * Busy/idle accounting for one worker thread
+ */
+struct WorkerStats {
+    size_t tasks = 0;            // Tasks executed
+    size_t steals = 0;           // Tasks taken from another worker's deque
+    double busy_seconds = 0.0;   // Time spent inside tasks
+    double idle_seconds = 0.0;   // Time spent looking for work or waiting
+};
+
+/**
+ * Work-stealing executor
+ * Each worker owns a deque seeded largest-cost-first. Owners pop from the
+ * front (largest remaining); idle workers steal from the back of a victim.
+ * Statistics accumulate over successive run() calls until resetStats().
+ */
+class WorkStealingExecutor {
+public:
+    explicit WorkStealingExecutor(size_t num_workers);
+
+    // Run fn(worker_index, task) for every task, largest estimated cost first
+    void run(std::vector<PrefixTask>& tasks,
+             const std::function<void(size_t, PrefixTask&)>& fn);
+
+    // Run fn(worker_index, task_index) for task indices 0..costs.size()-1
+    void run(const std::vector<double>& costs,
+             const std::function<void(size_t, size_t)>& fn);
+
+    size_t getWorkerCount() const { return num_workers_; }
+    void resetStats();
+    const std::vector<WorkerStats>& getWorkerStats() const { return stats_; }
+    double getWallSeconds() const { return wall_seconds_; }
+
+    // Human-readable per-worker busy/idle table
+    std::string getSummary() const;
+
+private:
+    size_t num_workers_;
+    std::vector<WorkerStats> stats_;
+    double wall_seconds_;
+};
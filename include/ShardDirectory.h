@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CSVInput.h"
+#include "PropagationFeatures.h"
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Shared work directory for prefix-sharded runs across processes or machines
+ * Layout (everything relative to the directory, which must be shared):
+ *   manifest.txt        shard count, snapshot file names and the options that
+ *                       change the RIBs (written last)
+ *   relationships.txt   graph snapshot
+ *   announcements.csv   all announcements (every worker needs the full ROA set)
+ *   rov_asns.csv        ROV adopters, if any
+ *   vantage_asns.txt    vantage points, if any
+ *   pending/            shard-NNNNN.csv announcement files waiting for a worker
+ *   claimed/            shards being simulated, suffixed with the worker id
+ *   ribs/               finished shard RIBs, named like the shard
+ * Claims and results are published with rename(), which is atomic within one
+ * file system, so workers need no lock service. A claim is a lease: its
+ * worker keeps touching the claimed file (see ShardLease), and a claim whose
+ * file has not been touched for the lease time is moved back to pending/ by
+ * reclaimExpired(), so a crashed worker's shards are picked up again.
+ */
+class ShardDirectory {
+public:
+    explicit ShardDirectory(const std::string& dir);
+
+    // Coordinator: snapshot the inputs and split the announcements into
+    // num_shards files by prefix (a prefix never spans two shards). The
+    // vantage points and tie-break rule go into the manifest, so every worker
+    // writes the same ASes' RIBs with the same decision process.
+    bool create(const std::string& relationships_file, const std::string& announcements_file,
+                const std::string& rov_asns_file, const std::string& vantage_file, TieBreak tie_break,
+                const std::vector<InputAnnouncement>& announcements, size_t num_shards);
+
+    // Read the manifest; false until the coordinator has finished create(),
+    // or (with an error) if the manifest is malformed
+    bool load();
+    bool hasManifest() const;
+
+    // Move one pending shard to claimed/; returns its claimed path, or "" when
+    // nothing is left to claim
+    std::string claim(const std::string& worker_id);
+
+    // Where a claimed shard's RIBs go before complete() publishes them and
+    // drops the claim
+    std::string getPartialFile(const std::string& claimed) const;
+    bool complete(const std::string& claimed);
+
+    // Give a claimed shard back (its worker failed on it): drop the partial
+    // RIBs and move it back to pending/
+    bool release(const std::string& claimed);
+
+    // Extend a claim's lease; false if the claim is gone (reclaimed)
+    bool renew(const std::string& claimed);
+
+    // Move every claim not renewed for lease_seconds back to pending/, unless
+    // its shard's RIBs are already published; returns the number of shards
+    // reclaimed
+    size_t reclaimExpired(double lease_seconds);
+
+    size_t getShardCount() const { return num_shards_; }
+    size_t getCompletedCount() const;
+    std::vector<std::string> getCompletedFiles() const;
+
+    const std::string& getRelationshipsFile() const { return relationships_file_; }
+    const std::string& getAnnouncementsFile() const { return announcements_file_; }
+    const std::string& getROVASNsFile() const { return rov_asns_file_; }
+    const std::string& getVantageFile() const { return vantage_file_; }
+    TieBreak getTieBreak() const { return tie_break_; }
+
+    // hostname:pid, unique across the processes sharing the directory
+    static std::string defaultWorkerId();
+
+private:
+    std::string dir_;
+    size_t num_shards_;
+    std::string relationships_file_;
+    std::string announcements_file_;
+    std::string rov_asns_file_;
+    std::string vantage_file_;
+    TieBreak tie_break_ = TieBreak::LOWEST_NEIGHBOR_ASN;
+
+    std::string path(const std::string& name) const;
+    static std::string getShardName(const std::string& claimed);
+};
+
+/**
+ * Keeps a claim's lease alive while its shard is simulated: renews it every
+ * renew_seconds on a background thread until destroyed
+ */
+class ShardLease {
+public:
+    ShardLease(ShardDirectory& shards, const std::string& claimed, double renew_seconds);
+    ~ShardLease();
+
+    ShardLease(const ShardLease&) = delete;
+    ShardLease& operator=(const ShardLease&) = delete;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable stop_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ASGraph.h"
+#include "CSVInput.h"
+#include "CSVOutput.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Data-plane traceback over converged RIBs
+ * The control plane keeps a victim /16 and an attacker /24 as separate
+ * prefixes, but packets follow the longest match. For a probe address,
+ * every AS forwards along its route for the most specific prefix it holds
+ * that covers the address. Following those next hops classifies each AS as
+ * reaching a legitimate origin, reaching an attacker (an origin of a
+ * ROV-invalid announcement), or disconnected (no covering route, or a
+ * forwarding loop). The walk is memoized, so each AS is resolved once.
+ *
+ * Every RIB holds a subset of the same simulated prefixes, so longest-prefix
+ * match is split in two: one shared table (a hash per prefix length) lists
+ * the prefixes covering the probe, longest first, and each AS takes the
+ * first of them it holds a route for.
+ */
+class Traceback {
+public:
+    enum class Outcome : uint8_t { ORIGIN, ATTACKER, DISCONNECTED };
+
+    // announcements and aliases as simulated (see PrefixClasses); without
+    // aliases every announced prefix stands for itself
+    Traceback(const ASGraph& graph, const std::vector<InputAnnouncement>& announcements,
+              const PrefixAliases& aliases);
+
+    // Network address of every announced prefix, for probing each one
+    std::vector<std::string> getDefaultProbes() const;
+
+    // Trace one probe; false if the address does not parse
+    bool trace(const std::string& address);
+
+    // Counts of the last trace, and ASes caught in forwarding loops
+    size_t getCount(Outcome outcome) const { return counts_[static_cast<size_t>(outcome)]; }
+    size_t getLoopCount() const { return loops_; }
+
+    // Append probe,asn,prefix,outcome rows of the last trace (prefix is the
+    // matched announced prefix, empty when disconnected)
+    void writeRows(std::ostream& out, const std::string& probe) const;
+
+    static const char* getOutcomeName(Outcome outcome);
+
+private:
+    const ASGraph& graph_;
+    std::vector<uint32_t> asns_;
+    std::unordered_map<uint32_t, uint32_t> index_;
+
+    // Shared LPM table: (family, length) -> masked address -> announced prefix
+    std::vector<std::string> prefixes_;          // Announced prefix per id
+    std::vector<std::string> simulated_;         // Prefix its routes are stored under
+    std::map<std::pair<bool, int>, std::unordered_map<std::string, uint32_t>, std::greater<>> table_;
+    std::set<std::pair<uint32_t, uint32_t>> attackers_;  // (prefix id, origin ASN)
+
+    // Last trace, per AS index
+    std::vector<Outcome> outcome_;
+    std::vector<uint32_t> matched_;  // Prefix id, or UINT32_MAX
+    size_t counts_[3] = {0, 0, 0};
+    size_t loops_ = 0;
+
+    // Address bytes (4 for IPv4, 16 for IPv6); false if text is not an address
+    static bool parseAddress(const std::string& text, bool& v6, std::string& bytes);
+    static std::string mask(const std::string& bytes, int length);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ASGraph.h"
+#include "CSVOutput.h"
+#include "Scheduler.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Best-path counts over next-hop trees, one prefix at a time
+ * A prefix's routes form a next-hop tree toward its origins. Visiting the
+ * routes longest path first, every AS hands the number of paths it carries
+ * (its own plus its dependents') to its next hop, so the counts come from
+ * the next hops alone and no path is expanded. One counter per worker;
+ * trees add up, as their prefixes are disjoint.
+ */
+class NextHopTreeLoad {
+public:
+    static constexpr uint32_t kNoHop = UINT32_MAX;
+
+    // One route of the tree: the AS, its next hop (kNoHop for an origin)
+    // and its path length, all ASes as dense indices
+    struct Route {
+        uint32_t as;
+        uint32_t hop;
+        uint32_t length;
+    };
+
+    explicit NextHopTreeLoad(size_t num_ases);
+
+    // Count one prefix's routes weight times; reorders routes
+    void addTree(std::vector<Route>& routes, uint64_t weight);
+
+    // Other ASes' paths crossing each AS before their origin
+    const std::vector<uint64_t>& getASPaths() const { return as_paths_; }
+
+    // (as << 32 | hop) -> paths using the link as -> hop, the AS's own included
+    const std::unordered_map<uint64_t, uint64_t>& getLinkPaths() const { return link_paths_; }
+
+private:
+    std::vector<uint64_t> carried_;  // Scratch: paths through each AS, zero between trees
+    std::vector<uint64_t> as_paths_;
+    std::unordered_map<uint64_t, uint64_t> link_paths_;
+};
+
+/**
+ * Transit dependence: how many (AS, prefix) best paths cross each AS and
+ * each directed link
+ * Each batch's prefixes are spread over the workers; a worker looks its
+ * prefix up in every AS's routing table and counts the tree with its own
+ * NextHopTreeLoad, so no second copy of the routes is built.
+ */
+class TransitLoad {
+public:
+    explicit TransitLoad(size_t num_threads);
+
+    // Count the routes graph holds for the count prefixes of tasks; a
+    // simulated prefix counts once per announced prefix it stands for
+    void add(const ASGraph& graph, const PrefixTask* tasks, size_t count, const PrefixAliases& aliases);
+
+    // kind,asn,next_hop,best_paths: "as" rows count other ASes' paths that
+    // cross the AS before their origin, "link" rows the paths using the link
+    // asn -> next_hop (the AS's own included); sorted by ASN, zero counts omitted
+    bool writeCSV(const std::string& filename) const;
+
+private:
+    WorkStealingExecutor executor_;
+    std::vector<uint32_t> asns_;          // Dense index -> ASN, set by the first add()
+    std::vector<NextHopTreeLoad> loads_;  // Per worker
+};
@@ -1,36 +1,58 @@
 #include "AS.h"
 #include "Announcement.h"
+#include "BestPath.h"
 #include "Policy.h"
 #include <algorithm>
 
+namespace {
+// Scratch buffers for batched best-path selection, reused across calls
+// (thread_local so worker replicas never share them)
+thread_local std::vector<uint32_t> accepted_candidates;
+thread_local CandidateBatch candidate_batch;
+
+// Keep neighbor lists sorted by ASN for deterministic processing. Inserting
+// in place (instead of re-sorting after every push) keeps loading linear
+// per insert even for ASes with thousands of neighbors.
+void insertByASN(std::vector<AS*>& neighbors, AS* neighbor) {
+    if (!neighbor) {
+        return;
+    }
+    auto pos = std::lower_bound(neighbors.begin(), neighbors.end(), neighbor,
+        [](const AS* a, const AS* b) { return a->getASN() < b->getASN(); });
+    if (pos == neighbors.end() || *pos != neighbor) {
+        neighbors.insert(pos, neighbor);
+    }
+}
+
+// Neighbor a route was learned from (the AS itself for an originated one)
+uint32_t getNeighbor(const Announcement& ann) {
+    const auto& path = ann.getASPath();
+    return path[path.size() > 1 ? 1 : 0];
+}
+}  // namespace
+
 AS::AS(uint32_t asn) 
-    : asn_(asn), propagation_rank_(-1), rov_validator_(nullptr), drop_invalid_(false) {}
+    : asn_(asn), propagation_rank_(-1), rov_validator_(nullptr), drop_invalid_(false),
+      active_(true) {}
 
 void AS::addProvider(AS* provider) {
-    if (provider && std::find(providers_.begin(), providers_.end(), provider) == providers_.end()) {
-        providers_.push_back(provider);
-        // Sort providers by ASN for deterministic processing
-        std::sort(providers_.begin(), providers_.end(),
-            [](const AS* a, const AS* b) { return a->getASN() < b->getASN(); });
-    }
+    insertByASN(providers_, provider);
 }
 
 void AS::addCustomer(AS* customer) {
-    if (customer && std::find(customers_.begin(), customers_.end(), customer) == customers_.end()) {
-        customers_.push_back(customer);
-        // Sort customers by ASN for deterministic processing
-        std::sort(customers_.begin(), customers_.end(),
-            [](const AS* a, const AS* b) { return a->getASN() < b->getASN(); });
-    }
+    insertByASN(customers_, customer);
 }
 
 void AS::addPeer(AS* peer) {
-    if (peer && std::find(peers_.begin(), peers_.end(), peer) == peers_.end()) {
-        peers_.push_back(peer);
-        // Sort peers by ASN for deterministic processing
-        std::sort(peers_.begin(), peers_.end(),
-            [](const AS* a, const AS* b) { return a->getASN() < b->getASN(); });
-    }
+    insertByASN(peers_, peer);
+}
+
+void AS::assignRelationships(const std::vector<AS*>& providers,
+                             const std::vector<AS*>& customers,
+                             const std::vector<AS*>& peers) {
+    providers_ = providers;
+    customers_ = customers;
+    peers_ = peers;
 }
 
 // Day 3-5: Announcement handling with policies and ROV
@@ -50,64 +72,208 @@ void AS::originatePrefix(const std::string& prefix) {
 }
 
 void AS::receiveAnnouncement(const Announcement& ann, AS* from) {
+    // Announcements from non-neighbors are never accepted
+    if (!active_ || !shouldAccept(ann, from)) {
+        return;
+    }
+
     // Queue the announcement for processing
-    incoming_queue_.push_back({ann, from});
+    incoming_queue_.push_back({ann, from, Policy::getRelationship(from, this)});
 }
 
-bool AS::processIncomingQueue() {
-    bool changed = false;
+void AS::enqueueAnnouncement(const Announcement& ann, AS* from, Relationship relationship) {
+    // Called by neighbors that already know how we learn the route from them
+    if (!active_) {
+        return;
+    }
+    incoming_queue_.push_back({ann, from, relationship});
+}
 
-    // Process all queued announcements
-    for (const auto& queued : incoming_queue_) {
-        const Announcement& ann = queued.ann;
-        AS* from = queued.from;
+void AS::installRoute(const Announcement& ann) {
+    routing_table_[ann.getPrefix()] = ann;
+}
 
-        // Check if we should accept this announcement
-        if (!shouldAccept(ann, from)) {
-            continue;
+void AS::clearRoutingTable() {
+    routing_table_.clear();
+    routes_to_propagate_.clear();
+    incoming_queue_.clear();
+    neighbor_routes_.clear();
+    changed_prefixes_.clear();
+    releaseAlternates();
+}
+
+void AS::swapRoutingTable(AS& other) {
+    routing_table_.swap(other.routing_table_);
+    adj_rib_in_.swap(other.adj_rib_in_);
+    for (AS* as_obj : {this, &other}) {
+        as_obj->routes_to_propagate_.clear();
+        as_obj->incoming_queue_.clear();
+        as_obj->neighbor_routes_.clear();
+        as_obj->changed_prefixes_.clear();
+    }
+}
+
+std::vector<AlternateRoute> AS::getAlternates(const std::string& prefix) const {
+    std::vector<AlternateRoute> alternates;
+    auto it = adj_rib_in_.find(prefix);
+    if (it == adj_rib_in_.end() || !alternate_budget_) {
+        return alternates;
+    }
+
+    // Neighbor of the installed route (this AS itself for an originated one)
+    uint32_t best_neighbor = asn_;
+    auto best = routing_table_.find(prefix);
+    if (best != routing_table_.end() && best->second.getASPath().size() > 1) {
+        best_neighbor = best->second.getASPath()[1];
+    }
+
+    const AlternateSet& set = it->second;
+    for (size_t i = 0; i < set.size() && alternates.size() < alternate_budget_->limit; i++) {
+        if (set.getNeighbor(i) != best_neighbor) {
+            alternates.push_back(set.getRoute(i));
+        }
+    }
+    return alternates;
+}
+
+void AS::adoptAlternates(AS& other) {
+    for (auto& [prefix, set] : other.adj_rib_in_) {
+        adj_rib_in_[prefix] = std::move(set);
+    }
+    other.adj_rib_in_.clear();  // Bytes stay charged to the shared budget
+}
+
+void AS::releaseAlternates() {
+    if (alternate_budget_) {
+        size_t bytes = 0;
+        for (const auto& [prefix, set] : adj_rib_in_) {
+            bytes += set.getMemoryBytes();
+        }
+        alternate_budget_->used_bytes -= bytes;
+    }
+    adj_rib_in_.clear();
+}
+
+template <typename Features>
+void AS::recordAlternate(const Announcement& ann) {
+    uint8_t rov_rank;
+    uint16_t local_pref;
+    uint16_t path_length;
+    uint32_t tie_break;
+    if (!getRankFields<Features>(ann, rov_rank, local_pref, path_length, tie_break)) {
+        return;  // Cannot be ranked by packed key; the route is still selected as usual
+    }
+    uint64_t key = BestPathSelector::packKey(rov_rank, local_pref, path_length, tie_break);
+
+    auto it = adj_rib_in_.find(ann.getPrefix());
+    if (it == adj_rib_in_.end()) {
+        if (alternate_budget_->isExhausted()) {
+            alternate_budget_->refused_routes++;
+            return;
+        }
+        it = adj_rib_in_.emplace(ann.getPrefix(), AlternateSet(alternate_budget_->limit + 1)).first;
+        alternate_budget_->used_bytes += it->second.getMemoryBytes();
+    }
+
+    size_t before = it->second.getMemoryBytes();
+    it->second.offer(key, ann.getASPath(), ann.getRelationship(), ann.getROVState());
+    alternate_budget_->used_bytes += it->second.getMemoryBytes();
+    alternate_budget_->used_bytes -= before;
+}
+
+template <typename Features>
+void AS::withdrawAlternate(const std::string& prefix, uint32_t neighbor,
+                           const std::vector<Announcement>& remaining) {
+    auto it = adj_rib_in_.find(prefix);
+    if (it == adj_rib_in_.end()) {
+        return;
+    }
+    AlternateSet& set = it->second;
+    bool was_full = set.size() == alternate_budget_->limit + 1;
+    if (!set.withdraw(neighbor) || !was_full) {
+        return;  // Every remaining route is already in a set that was not full
+    }
+
+    // A full set dropped lower-ranked routes; offer those not in it again
+    for (const Announcement& ann : remaining) {
+        uint32_t from = getNeighbor(ann);
+        bool kept = false;
+        for (size_t i = 0; i < set.size() && !kept; i++) {
+            kept = set.getNeighbor(i) == from;
         }
+        if (!kept) {
+            recordAlternate<Features>(ann);
+        }
+    }
+}
+
+bool AS::processIncomingQueue() {
+    return processIncomingQueueWith<DefaultPropagationFeatures>();
+}
+
+template <typename Features>
+bool AS::processIncomingQueueWith() {
+    bool changed = false;
+    std::vector<uint32_t>& accepted = accepted_candidates;
+    accepted.clear();
+
+    // Filter, prepend and validate every queued announcement in place
+    for (uint32_t i = 0; i < incoming_queue_.size(); i++) {
+        auto& queued = incoming_queue_[i];
 
         // Loop prevention: reject if our ASN is already in the path
-        if (ann.hasASN(asn_)) {
+        if (queued.ann.hasASN(asn_)) {
             continue;
         }
 
-        // Create a copy and prepend our ASN
-        Announcement new_ann = ann.copy();
+        // The queue owns its copy, so prepend our ASN in place
+        Announcement& new_ann = queued.ann;
         new_ann.prependASPath(asn_);
-
-        // Determine relationship with sender
-        Relationship rel = Policy::getRelationship(from, this);
-        new_ann.setRelationship(rel);
+        new_ann.setRelationship(queued.relationship);
 
         // Validate with ROV if available
-        if (rov_validator_) {
-            ROVState state = rov_validator_->validate(new_ann.getPrefix(), new_ann.getOrigin());
-            new_ann.setROVState(state);
-
-            // Drop INVALID routes if configured
-            if (drop_invalid_ && state == ROVState::INVALID) {
-                continue;  // Reject invalid route
+        if constexpr (Features::kROV) {
+            if (rov_validator_) {
+                ROVState state = rov_validator_->validate(new_ann.getPrefix(), new_ann.getOrigin());
+                new_ann.setROVState(state);
+
+                // Drop INVALID routes if configured
+                if (drop_invalid_ && state == ROVState::INVALID) {
+                    continue;  // Reject invalid route
+                }
             }
         }
 
-        const std::string& prefix = ann.getPrefix();
+        accepted.push_back(i);
+    }
+
+    // Keep every accepted candidate, not just the winners, when asked to
+    if (alternate_budget_) {
+        for (uint32_t i : accepted) {
+            recordAlternate<Features>(incoming_queue_[i].ann);
+        }
+    }
+
+    // Group candidates by prefix, keeping arrival order within each prefix
+    auto prefix_of = [this](uint32_t i) -> const std::string& {
+        return incoming_queue_[i].ann.getPrefix();
+    };
+    bool single_prefix = std::all_of(accepted.begin(), accepted.end(),
+        [&](uint32_t i) { return prefix_of(i) == prefix_of(accepted.front()); });
+    if (!single_prefix) {
+        std::stable_sort(accepted.begin(), accepted.end(),
+            [&](uint32_t a, uint32_t b) { return prefix_of(a) < prefix_of(b); });
+    }
 
-        // Check if we have a route for this prefix
-        auto it = routing_table_.find(prefix);
-        if (it == routing_table_.end()) {
-            // No existing route - accept
-            routing_table_.insert({prefix, new_ann});
-            routes_to_propagate_[prefix] = new_ann;
+    for (size_t begin = 0; begin < accepted.size();) {
+        size_t end = begin + 1;
+        while (end < accepted.size() && prefix_of(accepted[end]) == prefix_of(accepted[begin])) {
+            end++;
+        }
+        if (selectBestRoute<Features>(accepted.data() + begin, end - begin)) {
             changed = true;
-        } else {
-            // Have existing route - compare with policy-aware decision
-            if (isBetterPath(new_ann, it->second)) {
-                it->second = new_ann;
-                routes_to_propagate_[prefix] = new_ann;
-                changed = true;
-            }
         }
+        begin = end;
     }
 
     // Clear the queue
@@ -116,6 +282,233 @@ bool AS::processIncomingQueue() {
     return changed;
 }
 
+template <typename Features>
+bool AS::getRankFields(const Announcement& ann, uint8_t& rov_rank, uint16_t& local_pref,
+                       uint16_t& path_length, uint32_t& tie_break) const {
+    int pref = ann.getLocalPref();
+    int length = ann.getPathLength();
+    if (pref < 0 || pref > BestPathSelector::kMaxLocalPref ||
+        length > BestPathSelector::kMaxPathLength) {
+        return false;  // Does not fit the packed key
+    }
+    local_pref = static_cast<uint16_t>(pref);
+    path_length = static_cast<uint16_t>(length);
+
+    // Same ranking as isBetterPathWith: ROV state only matters for ROV-enabled ASes
+    rov_rank = 0;
+    if constexpr (Features::kROV) {
+        if (drop_invalid_ && rov_validator_) {
+            ROVState state = ann.getROVState();
+            rov_rank = state == ROVState::VALID ? 2 : (state == ROVState::UNKNOWN ? 1 : 0);
+        }
+    }
+
+    // Lower neighbor ASN wins, so store its complement; with OLDEST_PATH all
+    // candidates tie and argmax keeps the first one
+    tie_break = 0;
+    if constexpr (Features::kTieBreak == TieBreak::LOWEST_NEIGHBOR_ASN) {
+        const auto& path = ann.getASPath();
+        tie_break = ~path[std::min(path.size(), size_t(1))];
+    }
+    return true;
+}
+
+template <typename Features>
+bool AS::appendCandidate(CandidateBatch& batch, uint32_t idx, const Announcement& ann) const {
+    uint8_t rov_rank;
+    uint16_t local_pref;
+    uint16_t path_length;
+    uint32_t tie_break;
+    if (!getRankFields<Features>(ann, rov_rank, local_pref, path_length, tie_break)) {
+        return false;
+    }
+    batch.add(idx, rov_rank, local_pref, path_length, tie_break);
+    return true;
+}
+
+template <typename Features>
+bool AS::selectBestRoute(const uint32_t* candidates, size_t count) {
+    // Gather the candidates into SoA form and pick the winner by packed key
+    CandidateBatch& batch = candidate_batch;
+    batch.clear();
+    bool packable = true;
+    for (size_t k = 0; k < count && packable; k++) {
+        packable = appendCandidate<Features>(batch, candidates[k], incoming_queue_[candidates[k]].ann);
+    }
+
+    size_t winner = 0;
+    if (packable) {
+        BestPathSelector::packKeys(batch);
+        winner = BestPathSelector::argmax(batch.keys.data(), batch.size());
+    } else {
+        // Out-of-range field - fall back to pairwise comparison
+        for (size_t k = 1; k < count; k++) {
+            if (isBetterPathWith<Features>(incoming_queue_[candidates[k]].ann,
+                                           incoming_queue_[candidates[winner]].ann)) {
+                winner = k;
+            }
+        }
+    }
+
+    Announcement& best = incoming_queue_[candidates[winner]].ann;
+    const std::string prefix = best.getPrefix();  // Copy: best is moved below
+
+    // Check if we have a route for this prefix
+    auto it = routing_table_.find(prefix);
+    if (it == routing_table_.end()) {
+        // No existing route - accept
+        routes_to_propagate_[prefix] = best;
+        routing_table_.emplace(prefix, std::move(best));
+        return true;
+    }
+
+    // Have existing route - compare with policy-aware decision
+    if (isBetterPathWith<Features>(best, it->second)) {
+        routes_to_propagate_[prefix] = best;
+        it->second = std::move(best);
+        return true;
+    }
+
+    return false;
+}
+
+bool AS::markRoutesChanged() {
+    for (const auto& [prefix, ann] : routing_table_) {
+        changed_prefixes_.insert(prefix);
+
+        // An originated route stays a candidate for good
+        if (ann.getRelationship() == Relationship::ORIGIN) {
+            auto& routes = neighbor_routes_[prefix];
+            bool kept = std::any_of(routes.begin(), routes.end(),
+                [this](const Announcement& route) { return getNeighbor(route) == asn_; });
+            if (!kept) {
+                routes.push_back(ann);
+            }
+        }
+    }
+    return !changed_prefixes_.empty();
+}
+
+template <typename Features>
+void AS::sendChangedRoutesWith() {
+    std::unordered_set<std::string> prefixes;
+    prefixes.swap(changed_prefixes_);
+
+    for (const std::string& prefix : prefixes) {
+        auto it = routing_table_.find(prefix);
+        const Announcement* route = it != routing_table_.end() ? &it->second : nullptr;
+
+        // NO_ADVERTISE keeps the route from everyone, NO_EXPORT from peers and providers
+        bool advertise = route != nullptr;
+        bool export_beyond_customers = advertise;
+        if constexpr (Features::kCommunities) {
+            if (route) {
+                const CommunitySet& communities = route->getCommunities();
+                advertise = !communities.hasNoAdvertise();
+                export_beyond_customers = advertise && !communities.hasNoExport();
+            }
+        }
+
+        // Neighbors the route may not go to get a withdrawal, which is a
+        // no-op unless they hold an earlier route from this AS
+        auto send = [&](const std::vector<AS*>& neighbors, Relationship export_to, Relationship learned_as,
+                        bool allowed) {
+            const Announcement* sent =
+                allowed && Policy::shouldExport(route->getRelationship(), export_to, leak_routes_) ? route : nullptr;
+            for (AS* neighbor : neighbors) {
+                neighbor->receiveRouteWith<Features>(this, learned_as, prefix, sent);
+            }
+        };
+        send(customers_, Relationship::CUSTOMER, Relationship::PROVIDER, advertise);
+        send(peers_, Relationship::PEER, Relationship::PEER, export_beyond_customers);
+        send(providers_, Relationship::PROVIDER, Relationship::CUSTOMER, export_beyond_customers);
+    }
+}
+
+template <typename Features>
+void AS::receiveRouteWith(AS* from, Relationship relationship, const std::string& prefix,
+                          const Announcement* route) {
+    if (!active_) {
+        return;
+    }
+
+    // A route that loops or is dropped by ROV is as good as a withdrawal
+    bool usable = route && !route->hasASN(asn_);
+    auto found = neighbor_routes_.find(prefix);
+    if (!usable && found == neighbor_routes_.end()) {
+        return;
+    }
+    Announcement received;
+    if (usable) {
+        received = *route;
+        received.prependASPath(asn_);
+        received.setRelationship(relationship);
+        if constexpr (Features::kROV) {
+            if (rov_validator_) {
+                ROVState state = rov_validator_->validate(prefix, received.getOrigin());
+                received.setROVState(state);
+                usable = !(drop_invalid_ && state == ROVState::INVALID);
+            }
+        }
+    }
+
+    // Replace the neighbor's previous route
+    if (found == neighbor_routes_.end()) {
+        if (!usable) {
+            return;
+        }
+        found = neighbor_routes_.emplace(prefix, std::vector<Announcement>()).first;
+    }
+    auto& routes = found->second;
+    auto installed = routing_table_.find(prefix);
+    bool lost_installed = false;
+    auto held = std::find_if(routes.begin(), routes.end(),
+        [from](const Announcement& ann) { return getNeighbor(ann) == from->getASN(); });
+    if (held != routes.end()) {
+        if (usable && held->getASPath() == received.getASPath()) {
+            return;  // Sent again unchanged
+        }
+        lost_installed = installed != routing_table_.end() && installed->second.getASPath() == held->getASPath();
+        routes.erase(held);
+        if (alternate_budget_) {
+            withdrawAlternate<Features>(prefix, from->getASN(), routes);
+        }
+    } else if (!usable) {
+        return;
+    }
+    if (usable) {
+        if (alternate_budget_) {
+            recordAlternate<Features>(received);
+        }
+        routes.push_back(std::move(received));
+    }
+
+    if (lost_installed || installed == routing_table_.end()) {
+        if (routes.empty()) {
+            neighbor_routes_.erase(found);
+            if (installed == routing_table_.end()) {
+                return;
+            }
+            routing_table_.erase(installed);
+        } else {
+            // Best of the remaining routes; on a tie the oldest stays
+            size_t best = 0;
+            for (size_t k = 1; k < routes.size(); k++) {
+                if (isBetterPathWith<Features>(routes[k], routes[best])) {
+                    best = k;
+                }
+            }
+            routing_table_[prefix] = routes[best];
+        }
+    } else if (usable && isBetterPathWith<Features>(routes.back(), installed->second)) {
+        installed->second = routes.back();
+    } else {
+        return;
+    }
+
+    changed_prefixes_.insert(prefix);
+}
+
 void AS::propagate() {
     // Propagate all current routes (like BGPy's local_rib)
     for (const auto& [prefix, ann] : routing_table_) {
@@ -124,66 +517,74 @@ void AS::propagate() {
 }
 
 void AS::propagateToProviders() {
+    propagateToProvidersWith<DefaultPropagationFeatures>();
+}
+
+void AS::propagateToPeers() {
+    propagateToPeersWith<DefaultPropagationFeatures>();
+}
+
+void AS::propagateToCustomers() {
+    propagateToCustomersWith<DefaultPropagationFeatures>();
+}
+
+template <typename Features>
+void AS::propagateToProvidersWith() {
     // Only propagate to providers (BGPy Phase 1)
     for (const auto& [prefix, ann] : routing_table_) {
-        Relationship learnedFrom = ann.getRelationship();
-
-        // Check communities
-        if (ann.getCommunities().hasNoAdvertise()) {
-            continue;
-        }
-        bool no_export = ann.getCommunities().hasNoExport();
-        if (no_export) {
-            continue;  // NO_EXPORT means don't advertise to providers
+        // Check communities - NO_EXPORT means don't advertise to providers
+        if constexpr (Features::kCommunities) {
+            const CommunitySet& communities = ann.getCommunities();
+            if (communities.hasNoAdvertise() || communities.hasNoExport()) {
+                continue;
+            }
         }
 
-        // Export to providers (if policy allows)
-        if (Policy::shouldExport(learnedFrom, Relationship::PROVIDER)) {
+        // Export to providers (if policy allows); they learn it from a customer
+        if (Policy::shouldExport(ann.getRelationship(), Relationship::PROVIDER, leak_routes_)) {
             for (AS* provider : providers_) {
-                provider->receiveAnnouncement(ann, this);
+                provider->enqueueAnnouncement(ann, this, Relationship::CUSTOMER);
             }
         }
     }
 }
 
-void AS::propagateToPeers() {
+template <typename Features>
+void AS::propagateToPeersWith() {
     // Only propagate to peers (BGPy Phase 2)
     for (const auto& [prefix, ann] : routing_table_) {
-        Relationship learnedFrom = ann.getRelationship();
-
-        // Check communities
-        if (ann.getCommunities().hasNoAdvertise()) {
-            continue;
-        }
-        bool no_export = ann.getCommunities().hasNoExport();
-        if (no_export) {
-            continue;  // NO_EXPORT means don't advertise to peers
+        // Check communities - NO_EXPORT means don't advertise to peers
+        if constexpr (Features::kCommunities) {
+            const CommunitySet& communities = ann.getCommunities();
+            if (communities.hasNoAdvertise() || communities.hasNoExport()) {
+                continue;
+            }
         }
 
         // Export to peers (if policy allows)
-        if (Policy::shouldExport(learnedFrom, Relationship::PEER)) {
+        if (Policy::shouldExport(ann.getRelationship(), Relationship::PEER, leak_routes_)) {
             for (AS* peer : peers_) {
-                peer->receiveAnnouncement(ann, this);
+                peer->enqueueAnnouncement(ann, this, Relationship::PEER);
             }
         }
     }
 }
 
-void AS::propagateToCustomers() {
+template <typename Features>
+void AS::propagateToCustomersWith() {
     // Only propagate to customers (BGPy Phase 3)
     for (const auto& [prefix, ann] : routing_table_) {
-        Relationship learnedFrom = ann.getRelationship();
-
-        // Check communities
-        if (ann.getCommunities().hasNoAdvertise()) {
-            continue;
+        // Check communities - NO_EXPORT still allows advertising to customers
+        if constexpr (Features::kCommunities) {
+            if (ann.getCommunities().hasNoAdvertise()) {
+                continue;
+            }
         }
-        // NO_EXPORT still allows advertising to customers
 
-        // Export to customers (if policy allows)
-        if (Policy::shouldExport(learnedFrom, Relationship::CUSTOMER)) {
+        // Export to customers (if policy allows); they learn it from a provider
+        if (Policy::shouldExport(ann.getRelationship(), Relationship::CUSTOMER)) {
             for (AS* customer : customers_) {
-                customer->receiveAnnouncement(ann, this);
+                customer->enqueueAnnouncement(ann, this, Relationship::PROVIDER);
             }
         }
     }
@@ -199,69 +600,65 @@ bool AS::shouldAccept(const Announcement&, AS* from) const {
 }
 
 bool AS::isBetterPath(const Announcement& new_ann, const Announcement& old_ann) const {
+    return isBetterPathWith<DefaultPropagationFeatures>(new_ann, old_ann);
+}
+
+template <typename Features>
+bool AS::isBetterPathWith(const Announcement& new_ann, const Announcement& old_ann) const {
     // BGP decision process with policies and ROV:
 
     // 0. ROV state preference (ONLY for ROV-enabled ASes)
-    // Non-ROV ASes don't prefer VALID over INVALID, they just route normally
-    if (drop_invalid_ && rov_validator_) {
-        ROVState new_state = new_ann.getROVState();
-        ROVState old_state = old_ann.getROVState();
-
-        // Prefer VALID over UNKNOWN
-        if (new_state == ROVState::VALID && old_state != ROVState::VALID) {
-            return true;
-        }
-        if (old_state == ROVState::VALID && new_state != ROVState::VALID) {
-            return false;
-        }
+    // Non-ROV ASes don't prefer VALID over INVALID, they just route normally.
+    // ROV validates learned routes only: an AS keeps its own origination.
+    if constexpr (Features::kROV) {
+        if (drop_invalid_ && rov_validator_ && old_ann.getRelationship() != Relationship::ORIGIN &&
+            new_ann.getRelationship() != Relationship::ORIGIN) {
+            ROVState new_state = new_ann.getROVState();
+            ROVState old_state = old_ann.getROVState();
+
+            // Prefer VALID over UNKNOWN
+            if (new_state == ROVState::VALID && old_state != ROVState::VALID) {
+                return true;
+            }
+            if (old_state == ROVState::VALID && new_state != ROVState::VALID) {
+                return false;
+            }
 
-        // Prefer UNKNOWN over INVALID
-        if (new_state == ROVState::UNKNOWN && old_state == ROVState::INVALID) {
-            return true;
-        }
-        if (old_state == ROVState::UNKNOWN && new_state == ROVState::INVALID) {
-            return false;
+            // Prefer UNKNOWN over INVALID
+            if (new_state == ROVState::UNKNOWN && old_state == ROVState::INVALID) {
+                return true;
+            }
+            if (old_state == ROVState::UNKNOWN && new_state == ROVState::INVALID) {
+                return false;
+            }
         }
     }
-    
+
     // 1. Prefer higher local preference (based on relationship)
-    if (new_ann.getLocalPref() > old_ann.getLocalPref()) {
-        return true;
-    }
-    if (new_ann.getLocalPref() < old_ann.getLocalPref()) {
-        return false;
+    if (new_ann.getLocalPref() != old_ann.getLocalPref()) {
+        return new_ann.getLocalPref() > old_ann.getLocalPref();
     }
-    
+
     // 2. Prefer shorter AS path
-    if (new_ann.getPathLength() < old_ann.getPathLength()) {
-        return true;
+    if (new_ann.getPathLength() != old_ann.getPathLength()) {
+        return new_ann.getPathLength() < old_ann.getPathLength();
     }
-    if (new_ann.getPathLength() > old_ann.getPathLength()) {
-        return false;
-    }
-
-    // 3. Tie-break by neighbor ASN (BGPy algorithm)
-    // Use second element in path, or first if path has only one element
-    const auto& new_path = new_ann.getASPath();
-    const auto& old_path = old_ann.getASPath();
 
-    size_t new_neighbor_idx = std::min(new_path.size(), size_t(1));
-    size_t old_neighbor_idx = std::min(old_path.size(), size_t(1));
+    // 3. Tie-break
+    if constexpr (Features::kTieBreak == TieBreak::LOWEST_NEIGHBOR_ASN) {
+        // BGPy algorithm: use second element in path, or first if path has only one element
+        const auto& new_path = new_ann.getASPath();
+        const auto& old_path = old_ann.getASPath();
 
-    uint32_t new_neighbor = new_path[new_neighbor_idx];
-    uint32_t old_neighbor = old_path[old_neighbor_idx];
+        size_t new_neighbor_idx = std::min(new_path.size(), size_t(1));
+        size_t old_neighbor_idx = std::min(old_path.size(), size_t(1));
 
-    // Prefer lower neighbor ASN
-    if (new_neighbor < old_neighbor) {
-        return true;
-    }
-    if (new_neighbor > old_neighbor) {
+        // Prefer lower neighbor ASN
+        return new_path[new_neighbor_idx] < old_path[old_neighbor_idx];
+    } else {
+        // Keep the existing (oldest) path
         return false;
     }
-
-    // 4. Final tie-break: keep existing path (first-come, first-served)
-    // This ensures deterministic behavior
-    return false;
 }
 
 void AS::propagateToNeighbors(const Announcement& ann) {
@@ -289,15 +686,34 @@ void AS::propagateToNeighbors(const Announcement& ann) {
     
     // Export to peers (if policy allows)
     for (AS* peer : peers_) {
-        if (Policy::shouldExport(learnedFrom, Relationship::PEER)) {
+        if (Policy::shouldExport(learnedFrom, Relationship::PEER, leak_routes_)) {
             peer->receiveAnnouncement(ann, this);
         }
     }
     
     // Export to providers (if policy allows)
     for (AS* provider : providers_) {
-        if (Policy::shouldExport(learnedFrom, Relationship::PROVIDER)) {
+        if (Policy::shouldExport(learnedFrom, Relationship::PROVIDER, leak_routes_)) {
             provider->receiveAnnouncement(ann, this);
         }
     }
-}
\ No newline at end of file
+}
+
+// Explicit instantiations of the propagation kernel for every feature set
+#define INSTANTIATE_PROPAGATION_KERNEL(ROV, COMMUNITIES, RULE)                                   \
+    template bool AS::processIncomingQueueWith<PropagationFeatures<ROV, COMMUNITIES, RULE>>();  \
+    template void AS::propagateToProvidersWith<PropagationFeatures<ROV, COMMUNITIES, RULE>>();  \
+    template void AS::propagateToPeersWith<PropagationFeatures<ROV, COMMUNITIES, RULE>>();      \
+    template void AS::propagateToCustomersWith<PropagationFeatures<ROV, COMMUNITIES, RULE>>();  \
+    template void AS::sendChangedRoutesWith<PropagationFeatures<ROV, COMMUNITIES, RULE>>();
+
+INSTANTIATE_PROPAGATION_KERNEL(true, true, TieBreak::LOWEST_NEIGHBOR_ASN)
+INSTANTIATE_PROPAGATION_KERNEL(true, false, TieBreak::LOWEST_NEIGHBOR_ASN)
+INSTANTIATE_PROPAGATION_KERNEL(false, true, TieBreak::LOWEST_NEIGHBOR_ASN)
+INSTANTIATE_PROPAGATION_KERNEL(false, false, TieBreak::LOWEST_NEIGHBOR_ASN)
+INSTANTIATE_PROPAGATION_KERNEL(true, true, TieBreak::OLDEST_PATH)
+INSTANTIATE_PROPAGATION_KERNEL(true, false, TieBreak::OLDEST_PATH)
+INSTANTIATE_PROPAGATION_KERNEL(false, true, TieBreak::OLDEST_PATH)
+INSTANTIATE_PROPAGATION_KERNEL(false, false, TieBreak::OLDEST_PATH)
+
+#undef INSTANTIATE_PROPAGATION_KERNEL
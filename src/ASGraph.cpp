@@ -1,6 +1,9 @@
 #include "ASGraph.h"
 #include <algorithm>
 #include <iostream>
+#include <map>
+#include <tuple>
+#include <unordered_set>
 
 AS* ASGraph::getOrCreateAS(uint32_t asn) {
     auto it = ases_.find(asn);
@@ -21,6 +24,7 @@ void ASGraph::addRelationship(uint32_t provider_asn, uint32_t customer_asn) {
     
     provider->addCustomer(customer);
     customer->addProvider(provider);
+    cones_.clear();
 }
 
 void ASGraph::addPeeringRelationship(uint32_t asn1, uint32_t asn2) {
@@ -161,3 +165,534 @@ void ASGraph::assignRanksHelper(AS* as_obj, int rank) {
         }
     }
 }
+
+int ASGraph::propagateToConvergence() {
+    return propagateToConvergence(detectPropagationOptions());
+}
+
+PropagationOptions ASGraph::detectPropagationOptions() const {
+    PropagationOptions options;
+    options.rov = false;
+    options.communities = false;
+
+    for (const auto& [asn, as_ptr] : ases_) {
+        if (as_ptr->getDropInvalid()) {
+            options.rov = true;
+        }
+        for (const auto& [prefix, ann] : as_ptr->getRoutingTable()) {
+            if (!ann.getCommunities().empty()) {
+                options.communities = true;
+            }
+        }
+    }
+
+    return options;
+}
+
+int ASGraph::propagateToConvergence(const PropagationOptions& options) {
+    // Dispatch once per run to the matching kernel instantiation
+    if (options.tie_break == TieBreak::LOWEST_NEIGHBOR_ASN) {
+        if (options.rov) {
+            return options.communities
+                ? propagateToConvergenceWith<PropagationFeatures<true, true, TieBreak::LOWEST_NEIGHBOR_ASN>>()
+                : propagateToConvergenceWith<PropagationFeatures<true, false, TieBreak::LOWEST_NEIGHBOR_ASN>>();
+        }
+        return options.communities
+            ? propagateToConvergenceWith<PropagationFeatures<false, true, TieBreak::LOWEST_NEIGHBOR_ASN>>()
+            : propagateToConvergenceWith<PropagationFeatures<false, false, TieBreak::LOWEST_NEIGHBOR_ASN>>();
+    }
+
+    if (options.rov) {
+        return options.communities
+            ? propagateToConvergenceWith<PropagationFeatures<true, true, TieBreak::OLDEST_PATH>>()
+            : propagateToConvergenceWith<PropagationFeatures<true, false, TieBreak::OLDEST_PATH>>();
+    }
+    return options.communities
+        ? propagateToConvergenceWith<PropagationFeatures<false, true, TieBreak::OLDEST_PATH>>()
+        : propagateToConvergenceWith<PropagationFeatures<false, false, TieBreak::OLDEST_PATH>>();
+}
+
+template <typename Features>
+int ASGraph::propagateToConvergenceWith() {
+    if (keep_neighbor_routes_) {
+        return propagateEventsWith<Features>();
+    }
+
+    // BGPy-style hierarchical propagation until convergence
+    const auto& ranks = propagation_ranks_;
+    int round = 0;
+    bool changed = true;
+
+    while (changed) {
+        round++;
+        changed = false;
+
+        // Phase 1: Propagate to providers (bottom-up through ranks)
+        for (size_t i = 0; i < ranks.size(); i++) {
+            // Process incoming from lower ranks (customers)
+            if (i > 0) {
+                for (AS* as_ptr : ranks[i]) {
+                    if (as_ptr->processIncomingQueueWith<Features>()) {
+                        changed = true;
+                    }
+                }
+            }
+            // Propagate ONLY to providers (higher ranks)
+            for (AS* as_ptr : ranks[i]) {
+                as_ptr->propagateToProvidersWith<Features>();
+            }
+        }
+
+        // Phase 2: Propagate to peers (all ranks)
+        for (const auto& rank : ranks) {
+            for (AS* as_ptr : rank) {
+                as_ptr->propagateToPeersWith<Features>();
+            }
+        }
+        for (const auto& rank : ranks) {
+            for (AS* as_ptr : rank) {
+                if (as_ptr->processIncomingQueueWith<Features>()) {
+                    changed = true;
+                }
+            }
+        }
+
+        // Phase 3: Propagate to customers (top-down through ranks)
+        for (int i = ranks.size() - 1; i >= 0; i--) {
+            // Process incoming from higher ranks (providers)
+            if (i < (int)ranks.size() - 1) {
+                for (AS* as_ptr : ranks[i]) {
+                    if (as_ptr->processIncomingQueueWith<Features>()) {
+                        changed = true;
+                    }
+                }
+            }
+            // Propagate ONLY to customers (lower ranks)
+            for (AS* as_ptr : ranks[i]) {
+                as_ptr->propagateToCustomersWith<Features>();
+            }
+        }
+    }
+
+    return round;
+}
+
+template <typename Features>
+int ASGraph::propagateEventsWith() {
+    // Leaks break the valley-free order the phases rely on, so each round
+    // sweeps the ranks bottom-up and then top-down, and every AS with changed
+    // routes sends them when its turn comes. Changes made ahead of an AS in
+    // the sweep go out with its own, so changes chasing each other around a
+    // cycle of ASes merge instead of circling forever.
+    bool pending = false;
+    for (const auto& rank : propagation_ranks_) {
+        for (AS* as_ptr : rank) {
+            pending = as_ptr->markRoutesChanged() || pending;
+        }
+    }
+
+    int round = 0;
+    auto send = [](const std::vector<AS*>& rank) {
+        for (AS* as_ptr : rank) {
+            if (as_ptr->hasChangedRoutes()) {
+                as_ptr->sendChangedRoutesWith<Features>();
+            }
+        }
+    };
+    while (pending) {
+        round++;
+        for (const auto& rank : propagation_ranks_) {
+            send(rank);
+        }
+        for (auto rank = propagation_ranks_.rbegin(); rank != propagation_ranks_.rend(); ++rank) {
+            send(*rank);
+        }
+        pending = false;
+        for (const auto& rank : propagation_ranks_) {
+            for (const AS* as_ptr : rank) {
+                pending = pending || as_ptr->hasChangedRoutes();
+            }
+        }
+    }
+    return round;
+}
+
+size_t ASGraph::setLeakingASes(const std::vector<uint32_t>& asns) {
+    size_t leakers = 0;
+    for (uint32_t asn : asns) {
+        if (AS* as_obj = getAS(asn)) {
+            leakers += !as_obj->getLeakRoutes();
+            as_obj->setLeakRoutes(true);
+        }
+    }
+    keep_neighbor_routes_ = true;
+    return leakers;
+}
+
+std::unique_ptr<ASGraph> ASGraph::cloneTopology() const {
+    auto replica = std::make_unique<ASGraph>();
+    replica->rov_validator_ = rov_validator_;
+    replica->rov_enabled_ = rov_enabled_;
+
+    // Create every AS first so neighbor pointers can be translated
+    for (const auto& [asn, as_ptr] : ases_) {
+        AS* copy = replica->getOrCreateAS(asn);
+        copy->setPropagationRank(as_ptr->getPropagationRank());
+        copy->setDropInvalid(as_ptr->getDropInvalid());
+        copy->setLeakRoutes(as_ptr->getLeakRoutes());
+        copy->setActive(as_ptr->isActive());
+        copy->setROVValidator(&replica->rov_validator_);
+        copy->setAlternateBudget(alternate_budget_.get());
+    }
+    replica->alternate_budget_ = alternate_budget_;
+    replica->keep_neighbor_routes_ = keep_neighbor_routes_;
+
+    auto translate = [&replica](const std::vector<AS*>& neighbors) {
+        std::vector<AS*> result;
+        result.reserve(neighbors.size());
+        for (const AS* neighbor : neighbors) {
+            result.push_back(replica->getAS(neighbor->getASN()));
+        }
+        return result;
+    };
+
+    // Neighbor lists are already sorted by ASN, so assign them in bulk
+    for (const auto& [asn, as_ptr] : ases_) {
+        replica->getAS(asn)->assignRelationships(translate(as_ptr->getProviders()),
+                                                 translate(as_ptr->getCustomers()),
+                                                 translate(as_ptr->getPeers()));
+    }
+
+    replica->propagation_ranks_.reserve(propagation_ranks_.size());
+    for (const auto& rank : propagation_ranks_) {
+        replica->propagation_ranks_.push_back(translate(rank));
+    }
+
+    for (const auto& [asn, derived] : derived_) {
+        replica->derived_[asn] = DerivedAS{replica->getAS(derived.source->getASN()), derived.stub};
+    }
+
+    return replica;
+}
+
+void ASGraph::clearRoutingTables() {
+    for (const auto& [asn, as_ptr] : ases_) {
+        as_ptr->clearRoutingTable();
+    }
+}
+
+void ASGraph::swapRoutingTables(ASGraph& other) {
+    for (const auto& [asn, as_ptr] : ases_) {
+        if (AS* twin = other.getAS(asn)) {
+            as_ptr->swapRoutingTable(*twin);
+        }
+    }
+}
+
+void ASGraph::keepAlternateRoutes(size_t limit, size_t max_bytes) {
+    alternate_budget_ = std::make_shared<AlternateBudget>();
+    alternate_budget_->limit = limit;
+    alternate_budget_->max_bytes = max_bytes;
+    for (const auto& [asn, as_ptr] : ases_) {
+        as_ptr->setAlternateBudget(alternate_budget_.get());
+    }
+}
+
+std::vector<AlternateRoute> ASGraph::findAlternateRoutes(uint32_t asn, const std::string& prefix) const {
+    const AS* as_obj = getAS(asn);
+    return as_obj ? as_obj->getAlternates(prefix) : std::vector<AlternateRoute>();
+}
+
+size_t ASGraph::getCustomerConeSize(uint32_t asn) const {
+    if (!cones_.empty()) {
+        auto it = cone_index_.find(asn);
+        return it != cone_index_.end() ? cones_[it->second].size() : 0;
+    }
+
+    const AS* root = getAS(asn);
+    if (!root) {
+        return 0;
+    }
+
+    // BFS down the customer edges
+    std::unordered_set<const AS*> visited{root};
+    std::vector<const AS*> frontier{root};
+    while (!frontier.empty()) {
+        const AS* current = frontier.back();
+        frontier.pop_back();
+        for (const AS* customer : current->getCustomers()) {
+            if (visited.insert(customer).second) {
+                frontier.push_back(customer);
+            }
+        }
+    }
+
+    return visited.size();
+}
+
+void ASGraph::computeCustomerCones() {
+    cone_asns_.clear();
+    cone_index_.clear();
+    cone_index_.reserve(ases_.size());
+    for (const auto& [asn, as_ptr] : ases_) {
+        cone_index_[asn] = static_cast<uint32_t>(cone_asns_.size());
+        cone_asns_.push_back(asn);
+    }
+
+    // Every AS ranks above its customers, so going up the ranks finds each
+    // customer's cone complete. Derived and pruned ASes have left
+    // propagation_ranks_ but kept their rank, so bucket them by it directly.
+    std::vector<std::vector<const AS*>> ranks;
+    for (const auto& [asn, as_ptr] : ases_) {
+        size_t rank = static_cast<size_t>(std::max(as_ptr->getPropagationRank(), 0));
+        if (rank >= ranks.size()) {
+            ranks.resize(rank + 1);
+        }
+        ranks[rank].push_back(as_ptr.get());
+    }
+
+    std::vector<ConeSet> cones(ases_.size());
+    for (const auto& rank : ranks) {
+        for (const AS* as_obj : rank) {
+            ConeSet& cone = cones[cone_index_[as_obj->getASN()]];
+            cone.add(cone_index_[as_obj->getASN()]);
+            for (const AS* customer : as_obj->getCustomers()) {
+                cone.unionWith(cones[cone_index_[customer->getASN()]]);
+            }
+        }
+    }
+    cones_ = std::move(cones);
+}
+
+size_t ASGraph::getCustomerConeMemoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& cone : cones_) {
+        bytes += cone.getMemoryBytes();
+    }
+    return bytes;
+}
+
+bool ASGraph::isInCustomerCone(uint32_t provider_asn, uint32_t asn) const {
+    auto provider = cone_index_.find(provider_asn);
+    auto member = cone_index_.find(asn);
+    if (cones_.empty() || provider == cone_index_.end() || member == cone_index_.end()) {
+        return false;
+    }
+    return cones_[provider->second].contains(member->second);
+}
+
+std::vector<uint32_t> ASGraph::getCustomerCone(uint32_t asn) const {
+    std::vector<uint32_t> asns;
+    auto it = cone_index_.find(asn);
+    if (cones_.empty() || it == cone_index_.end()) {
+        return asns;
+    }
+    for (uint32_t index : cones_[it->second].toVector()) {
+        asns.push_back(cone_asns_[index]);
+    }
+    return asns;
+}
+
+size_t ASGraph::compactTopology(const std::unordered_set<uint32_t>& origins, bool merge_equivalent) {
+    auto asns = [](const std::vector<AS*>& neighbors) {
+        std::vector<uint32_t> result;
+        result.reserve(neighbors.size());
+        for (const AS* neighbor : neighbors) {
+            result.push_back(neighbor->getASN());
+        }
+        return result;
+    };
+
+    // Neighbor sets plus ROV policy; std::map iterates in ASN order, so the
+    // first AS seen with a signature is the lowest ASN in its group
+    using Signature = std::tuple<std::vector<uint32_t>, std::vector<uint32_t>,
+                                 std::vector<uint32_t>, bool>;
+    std::map<Signature, const AS*> representatives;
+
+    for (const auto& [asn, as_ptr] : ases_) {
+        if (origins.count(asn) || !as_ptr->isActive()) {
+            continue;
+        }
+
+        const auto& providers = as_ptr->getProviders();
+        if (providers.size() == 1 && as_ptr->getCustomers().empty() && as_ptr->getPeers().empty()) {
+            derived_[asn] = DerivedAS{providers.front(), true};
+            continue;
+        }
+
+        if (merge_equivalent) {
+            Signature signature(asns(providers), asns(as_ptr->getCustomers()),
+                                asns(as_ptr->getPeers()), as_ptr->getDropInvalid());
+            auto [it, inserted] = representatives.emplace(std::move(signature), as_ptr.get());
+            if (!inserted) {
+                derived_[asn] = DerivedAS{it->second, false};
+            }
+        }
+    }
+
+    for (const auto& [asn, derived] : derived_) {
+        getAS(asn)->setActive(false);
+    }
+    dropInactiveFromRanks();
+
+    return derived_.size();
+}
+
+void ASGraph::dropInactiveFromRanks() {
+    for (auto& rank : propagation_ranks_) {
+        rank.erase(std::remove_if(rank.begin(), rank.end(),
+                                  [](const AS* as_obj) { return !as_obj->isActive(); }),
+                   rank.end());
+    }
+}
+
+void ASGraph::restoreTopology() {
+    // Derived and pruned ASes kept their rank; ases_ is in ASN order, so the
+    // ranks come out sorted as in computePropagationRanks()
+    derived_.clear();
+    for (auto& rank : propagation_ranks_) {
+        rank.clear();
+    }
+    for (const auto& [asn, as_ptr] : ases_) {
+        as_ptr->setActive(true);
+        as_ptr->clearRoutingTable();
+        propagation_ranks_[as_ptr->getPropagationRank()].push_back(as_ptr.get());
+    }
+}
+
+size_t ASGraph::restrictToVantagePoints(const std::vector<uint32_t>& vantage_asns,
+                                        const std::unordered_set<uint32_t>& origins) {
+    std::unordered_set<const AS*> upstream;
+    std::vector<const AS*> frontier;
+
+    // Only the origins and the ASes above them can hold customer routes
+    std::unordered_set<const AS*> carriers;
+    for (uint32_t asn : origins) {
+        const AS* origin = getAS(asn);
+        if (origin && carriers.insert(origin).second) {
+            frontier.push_back(origin);
+        }
+    }
+    while (!frontier.empty()) {
+        const AS* current = frontier.back();
+        frontier.pop_back();
+        for (const AS* provider : current->getProviders()) {
+            if (provider->isActive() && carriers.insert(provider).second) {
+                frontier.push_back(provider);
+            }
+        }
+    }
+
+    for (uint32_t asn : vantage_asns) {
+        const AS* as_obj = getAS(asn);
+        if (!as_obj) {
+            continue;
+        }
+        auto derived = derived_.find(asn);
+        if (derived != derived_.end()) {
+            as_obj = derived->second.source;
+        }
+        if (upstream.insert(as_obj).second) {
+            frontier.push_back(as_obj);
+        }
+    }
+
+    // Provider chains above the vantage points
+    while (!frontier.empty()) {
+        const AS* current = frontier.back();
+        frontier.pop_back();
+        for (const AS* provider : current->getProviders()) {
+            if (provider->isActive() && upstream.insert(provider).second) {
+                frontier.push_back(provider);
+            }
+        }
+    }
+
+    // Customer cones of the upstream ASes and their peers, limited to the
+    // ASes that can carry a customer route
+    std::unordered_set<const AS*> keep(upstream.begin(), upstream.end());
+    for (const AS* as_obj : upstream) {
+        frontier.push_back(as_obj);
+        for (const AS* peer : as_obj->getPeers()) {
+            if (carriers.count(peer) && keep.insert(peer).second) {
+                frontier.push_back(peer);
+            }
+        }
+    }
+    while (!frontier.empty()) {
+        const AS* current = frontier.back();
+        frontier.pop_back();
+        for (const AS* customer : current->getCustomers()) {
+            if (carriers.count(customer) && keep.insert(customer).second) {
+                frontier.push_back(customer);
+            }
+        }
+    }
+
+    for (const auto& [asn, as_ptr] : ases_) {
+        if (!keep.count(as_ptr.get())) {
+            as_ptr->setActive(false);
+        }
+    }
+    dropInactiveFromRanks();
+
+    return keep.size();
+}
+
+std::optional<Announcement> ASGraph::deriveRoute(const AS& as_obj, const DerivedAS& derived,
+                                                 const Announcement& source_route) const {
+    std::vector<uint32_t> path = source_route.getASPath();
+    if (derived.stub) {
+        // A stub only hears from its provider
+        if (as_obj.getDropInvalid() && source_route.getROVState() == ROVState::INVALID) {
+            return std::nullopt;
+        }
+        path.insert(path.begin(), as_obj.getASN());
+    } else {
+        path.front() = as_obj.getASN();
+    }
+
+    Announcement route = source_route;
+    route.setASPath(path);
+    if (derived.stub) {
+        route.setRelationship(Relationship::PROVIDER);
+    }
+    return route;
+}
+
+std::unordered_map<std::string, Announcement> ASGraph::getRoutingTable(uint32_t asn) const {
+    const AS* as_obj = getAS(asn);
+    if (!as_obj) {
+        return {};
+    }
+    auto it = derived_.find(asn);
+    if (it == derived_.end()) {
+        return as_obj->getRoutingTable();
+    }
+
+    std::unordered_map<std::string, Announcement> table;
+    for (const auto& [prefix, source_route] : it->second.source->getRoutingTable()) {
+        if (auto route = deriveRoute(*as_obj, it->second, source_route)) {
+            table.emplace(prefix, std::move(*route));
+        }
+    }
+    return table;
+}
+
+std::optional<Announcement> ASGraph::findRoute(uint32_t asn, const std::string& prefix) const {
+    const AS* as_obj = getAS(asn);
+    if (!as_obj) {
+        return std::nullopt;
+    }
+
+    auto it = derived_.find(asn);
+    const AS* holder = it == derived_.end() ? as_obj : it->second.source;
+    auto route = holder->getRoutingTable().find(prefix);
+    if (route == holder->getRoutingTable().end()) {
+        return std::nullopt;
+    }
+    if (it == derived_.end()) {
+        return route->second;
+    }
+    return deriveRoute(*as_obj, it->second, route->second);
+}
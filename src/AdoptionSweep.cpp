@@ -0,0 +1,189 @@
+#include "AdoptionSweep.h"
+#include "RouteKey.h"
+#include "RouteSolver.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <unordered_set>
+#include <utility>
+
+AdoptionSweep::AdoptionSweep(const ASGraph& graph,
+                             const std::vector<InputAnnouncement>& announcements,
+                             size_t num_threads)
+    : topology_(graph), executor_(num_threads) {
+    // Precomputed by graph.computeCustomerCones(), or walked per AS
+    cone_sizes_.reserve(topology_.size());
+    for (uint32_t v = 0; v < topology_.size(); v++) {
+        cone_sizes_.push_back(static_cast<double>(graph.getCustomerConeSize(topology_.getASN(v))));
+    }
+    for (const auto& ann : announcements) {
+        if (!ann.rov_invalid) {
+            validator_.addROA(ann.prefix, ann.asn);
+        }
+    }
+
+    // Only prefixes with an invalid origin can be hijacked
+    std::unordered_set<std::string> contested;
+    for (const auto& ann : announcements) {
+        if (ann.rov_invalid) {
+            contested.insert(ann.prefix);
+        }
+    }
+    for (auto& task : PrefixCostModel::buildTasks(announcements)) {
+        if (!contested.count(task.prefix)) {
+            continue;
+        }
+        std::vector<uint32_t> origins;
+        for (const auto& ann : task.announcements) {
+            uint32_t index = topology_.getIndex(ann.asn);
+            if (index != IndexedGraph::kNoIndex &&
+                std::find(origins.begin(), origins.end(), index) == origins.end()) {
+                origins.push_back(index);
+            }
+        }
+        origins_.push_back(std::move(origins));
+        tasks_.push_back(std::move(task));
+    }
+}
+
+void AdoptionSweep::run(const std::vector<double>& percents, size_t trials, uint64_t seed,
+                        Weighting weighting) {
+    const size_t n = topology_.size();
+    percents_ = percents;
+    trials_ = trials;
+    adopters_.clear();
+    for (double percent : percents_) {
+        adopters_.push_back(static_cast<size_t>(std::llround(percent / 100.0 * n)));
+    }
+    outcomes_.assign(percents_.size() * trials_, Outcome());
+
+    std::vector<double> weights = weighting == Weighting::CUSTOMER_CONE
+        ? cone_sizes_ : std::vector<double>(n, 1.0);
+
+    // Per-worker ROV flags and a solver reading them
+    const size_t workers = executor_.getWorkerCount();
+    std::vector<std::vector<uint8_t>> drop(workers, std::vector<uint8_t>(n, 0));
+    std::vector<std::unique_ptr<RouteSolver>> solvers;
+    for (size_t w = 0; w < workers; w++) {
+        solvers.push_back(std::make_unique<RouteSolver>(topology_, validator_, drop[w]));
+    }
+
+    std::vector<double> costs(outcomes_.size(), 1.0);
+    executor_.run(costs, [&](size_t worker, size_t index) {
+        size_t p = index / trials_;
+        size_t trial = index % trials_;
+        size_t k = adopters_[p];
+        std::vector<uint8_t>& adopting = drop[worker];
+        RouteSolver& solver = *solvers[worker];
+
+        // Weighted sample without replacement (Efraimidis-Spirakis): the k
+        // largest log(u) / w
+        std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                          static_cast<uint32_t>(p), static_cast<uint32_t>(trial)};
+        std::mt19937_64 rng(seq);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<std::pair<double, uint32_t>> keys(n);
+        for (uint32_t v = 0; v < n; v++) {
+            keys[v] = {std::log(1.0 - uniform(rng)) / weights[v], v};
+        }
+        if (k < n) {
+            std::nth_element(keys.begin(), keys.begin() + k, keys.end(),
+                             [](const auto& a, const auto& b) { return a.first > b.first; });
+        }
+        for (size_t i = 0; i < k; i++) {
+            adopting[keys[i].second] = 1;
+        }
+
+        size_t population = 0, adopting_population = 0;
+        size_t hijacked = 0, legitimate = 0, hijacked_adopting = 0;
+        for (size_t t = 0; t < tasks_.size(); t++) {
+            const auto& origins = origins_[t];
+            size_t adopting_origins = 0;
+            for (uint32_t origin : origins) {
+                adopting_origins += adopting[origin];
+            }
+            population += n - origins.size();
+            adopting_population += k - adopting_origins;
+
+            solver.compute(tasks_[t]);
+            for (uint32_t v : solver.getReached()) {
+                if (std::find(origins.begin(), origins.end(), v) != origins.end()) {
+                    continue;
+                }
+                if (RouteKey::getROVState(solver.getKey(v)) == ROVState::INVALID) {
+                    hijacked++;
+                    hijacked_adopting += adopting[v];
+                } else {
+                    legitimate++;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < k; i++) {
+            adopting[keys[i].second] = 0;
+        }
+
+        Outcome& outcome = outcomes_[index];
+        size_t non_adopting_population = population - adopting_population;
+        if (population > 0) {
+            outcome.hijacked = double(hijacked) / population;
+            outcome.legitimate = double(legitimate) / population;
+            outcome.disconnected = double(population - hijacked - legitimate) / population;
+        }
+        if (adopting_population > 0) {
+            outcome.hijacked_adopting = double(hijacked_adopting) / adopting_population;
+        }
+        if (non_adopting_population > 0) {
+            outcome.hijacked_non_adopting =
+                double(hijacked - hijacked_adopting) / non_adopting_population;
+        }
+    });
+}
+
+bool AdoptionSweep::writeCSV(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    static const std::pair<const char*, double Outcome::*> kFields[] = {
+        {"hijacked", &Outcome::hijacked},
+        {"legitimate", &Outcome::legitimate},
+        {"disconnected", &Outcome::disconnected},
+        {"hijacked_adopting", &Outcome::hijacked_adopting},
+        {"hijacked_non_adopting", &Outcome::hijacked_non_adopting},
+    };
+
+    file << "adoption_pct,trials,adopters";
+    for (const auto& [name, field] : kFields) {
+        file << "," << name << "_mean," << name << "_ci95";
+    }
+    file << "\n";
+
+    file.precision(6);
+    for (size_t p = 0; p < percents_.size(); p++) {
+        file << percents_[p] << "," << trials_ << "," << adopters_[p];
+        for (const auto& [name, field] : kFields) {
+            // Mean and normal-approximation 95% interval half-width
+            double sum = 0.0, sum_sq = 0.0;
+            for (size_t t = 0; t < trials_; t++) {
+                double value = outcomes_[p * trials_ + t].*field;
+                sum += value;
+                sum_sq += value * value;
+            }
+            double mean = trials_ ? sum / trials_ : 0.0;
+            double ci = 0.0;
+            if (trials_ > 1) {
+                double variance = std::max(0.0, (sum_sq - trials_ * mean * mean) / (trials_ - 1));
+                ci = 1.96 * std::sqrt(variance / trials_);
+            }
+            file << "," << mean << "," << ci;
+        }
+        file << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#include "AlternateRoutes.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace {
+// Hash map node and bucket overhead per kept set (libstdc++, 64-bit)
+constexpr size_t kMapEntryBytes = sizeof(std::string) + 32;
+// glibc chunk header of the slot block
+constexpr size_t kMallocChunkHeader = 16;
+}  // namespace
+
+uint64_t AlternateSet::getKey(size_t i) const {
+    uint64_t key;
+    std::memcpy(&key, getSlot(i), sizeof(key));
+    return key;
+}
+
+uint32_t AlternateSet::getNeighbor(size_t i) const {
+    const uint32_t* slot = getSlot(i);
+    return slot[kSlotHeaderWords + (slot[2] > 1 ? 1 : 0)];
+}
+
+AlternateRoute AlternateSet::getRoute(size_t i) const {
+    const uint32_t* slot = getSlot(i);
+    AlternateRoute route;
+    route.key = getKey(i);
+    route.path.assign(slot + kSlotHeaderWords, slot + kSlotHeaderWords + slot[2]);
+    route.relationship = static_cast<Relationship>(slot[3] & 0xFF);
+    route.rov_state = static_cast<ROVState>(slot[3] >> 8);
+    return route;
+}
+
+void AlternateSet::reserve(size_t path_length) {
+    if (block_ && path_length <= path_words_) {
+        return;
+    }
+    size_t old_slot_words = getSlotWords();
+    path_words_ = static_cast<uint32_t>(std::max({path_length, kMinPathWords, size_t(path_words_)}));
+    std::unique_ptr<uint32_t[]> block(new uint32_t[capacity_ * getSlotWords()]);
+    for (size_t i = 0; i < count_; i++) {
+        std::memcpy(block.get() + i * getSlotWords(), block_.get() + i * old_slot_words,
+                    old_slot_words * sizeof(uint32_t));
+    }
+    block_ = std::move(block);
+}
+
+bool AlternateSet::withdraw(uint32_t neighbor) {
+    for (size_t i = 0; i < count_; i++) {
+        if (getNeighbor(i) == neighbor) {
+            std::memmove(getSlot(i), getSlot(i + 1),
+                         (count_ - i - 1) * getSlotWords() * sizeof(uint32_t));
+            count_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void AlternateSet::offer(uint64_t key, const std::vector<uint32_t>& path, Relationship relationship,
+                         ROVState rov_state) {
+    // Drop the neighbor's previous route
+    withdraw(path[path.size() > 1 ? 1 : 0]);
+
+    // Equal keys keep the older route first, like the oldest-path tie-break
+    size_t pos = 0;
+    while (pos < count_ && getKey(pos) >= key) {
+        pos++;
+    }
+    if (pos >= capacity_) {
+        return;
+    }
+    reserve(path.size());
+    if (count_ == capacity_) {
+        count_--;
+    }
+    std::memmove(getSlot(pos + 1), getSlot(pos), (count_ - pos) * getSlotWords() * sizeof(uint32_t));
+
+    uint32_t* slot = getSlot(pos);
+    std::memcpy(slot, &key, sizeof(key));
+    slot[2] = static_cast<uint32_t>(path.size());
+    slot[3] = static_cast<uint32_t>(relationship) | static_cast<uint32_t>(rov_state) << 8;
+    std::copy(path.begin(), path.end(), slot + kSlotHeaderWords);
+    count_++;
+}
+
+size_t AlternateSet::getMemoryBytes() const {
+    size_t bytes = sizeof(AlternateSet) + kMapEntryBytes;
+    if (block_) {
+        bytes += capacity_ * getSlotWords() * sizeof(uint32_t) + kMallocChunkHeader;
+    }
+    return bytes;
+}
@@ -0,0 +1,127 @@
+#include "BestPath.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BGP_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+void CandidateBatch::clear() {
+    index.clear();
+    rov_rank.clear();
+    local_pref.clear();
+    path_length.clear();
+    tie_break.clear();
+    keys.clear();
+}
+
+void CandidateBatch::add(uint32_t idx, uint8_t rov, uint16_t pref, uint16_t length, uint32_t tie) {
+    index.push_back(idx);
+    rov_rank.push_back(rov);
+    local_pref.push_back(pref);
+    path_length.push_back(length);
+    tie_break.push_back(tie);
+}
+
+void BestPathSelector::packKeys(CandidateBatch& batch) {
+    const size_t n = batch.size();
+    batch.keys.resize(n);
+
+    // Plain loop over the SoA fields so the compiler can vectorize it
+    const uint8_t* rov = batch.rov_rank.data();
+    const uint16_t* pref = batch.local_pref.data();
+    const uint16_t* length = batch.path_length.data();
+    const uint32_t* tie = batch.tie_break.data();
+    uint64_t* keys = batch.keys.data();
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = packKey(rov[i], pref[i], length[i], tie[i]);
+    }
+}
+
+namespace {
+
+size_t argmaxScalar(const uint64_t* keys, size_t n) {
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (keys[i] > keys[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+#ifdef BGP_HAVE_AVX2_KERNEL
+__attribute__((target("avx2")))
+size_t argmaxAVX2(const uint64_t* keys, size_t n) {
+    if (n < 8) {
+        return argmaxScalar(keys, n);
+    }
+
+    // AVX2 only has signed 64-bit compares: flip the sign bit so unsigned
+    // order maps onto signed order
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+
+    // Pass 1: lane-wise running maximum
+    __m256i best = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys)), bias);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+        __m256i greater = _mm256_cmpgt_epi64(v, best);
+        best = _mm256_blendv_epi8(best, v, greater);
+    }
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_xor_si256(best, bias));
+    uint64_t max_key = lanes[0];
+    for (int lane = 1; lane < 4; lane++) {
+        max_key = lanes[lane] > max_key ? lanes[lane] : max_key;
+    }
+    for (; i < n; i++) {
+        max_key = keys[i] > max_key ? keys[i] : max_key;
+    }
+
+    // Pass 2: first position holding the maximum (keeps first-come order on ties)
+    const __m256i target = _mm256_set1_epi64x(static_cast<long long>(max_key));
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + j)), target);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        if (mask) {
+            return j + __builtin_ctz(mask);
+        }
+    }
+    for (; j < n; j++) {
+        if (keys[j] == max_key) {
+            break;
+        }
+    }
+    return j;
+}
+#endif
+
+using ArgmaxFn = size_t (*)(const uint64_t*, size_t);
+
+ArgmaxFn selectArgmax() {
+#ifdef BGP_HAVE_AVX2_KERNEL
+    if (__builtin_cpu_supports("avx2")) {
+        return argmaxAVX2;
+    }
+#endif
+    return argmaxScalar;
+}
+
+const ArgmaxFn argmax_impl = selectArgmax();
+
+}  // namespace
+
+size_t BestPathSelector::argmax(const uint64_t* keys, size_t n) {
+    return argmax_impl(keys, n);
+}
+
+const char* BestPathSelector::getKernelName() {
+#ifdef BGP_HAVE_AVX2_KERNEL
+    if (argmax_impl == argmaxAVX2) {
+        return "avx2";
+    }
+#endif
+    return "scalar";
+}
@@ -84,11 +84,15 @@ std::vector<InputAnnouncement> CSVInput::parseAnnouncements(const std::string& f
 }
 
 std::vector<uint32_t> CSVInput::parseROVASNs(const std::string& filename) {
+    return parseASNList(filename, "ROV ASNs");
+}
+
+std::vector<uint32_t> CSVInput::parseASNList(const std::string& filename, const std::string& what) {
     std::vector<uint32_t> rov_asns;
     std::ifstream file(filename);
     
     if (!file.is_open()) {
-        std::cerr << "Error: Could not open ROV ASNs file: " << filename << std::endl;
+        std::cerr << "Error: Could not open " << what << " file: " << filename << std::endl;
         return rov_asns;
     }
     
@@ -124,7 +128,7 @@ std::vector<uint32_t> CSVInput::parseROVASNs(const std::string& filename) {
     }
     
     file.close();
-    std::cout << "Loaded " << rov_asns.size() << " ROV ASNs from " 
+    std::cout << "Loaded " << rov_asns.size() << " " << what << " from " 
               << filename << std::endl;
     
     return rov_asns;
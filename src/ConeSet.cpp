@@ -0,0 +1,145 @@
+#include "ConeSet.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+void ConeSet::Container::toBitmap() {
+    bitmap.assign(kBitmapWords, 0);
+    for (uint16_t low : array) {
+        bitmap[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void ConeSet::add(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value);
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) {
+        Container container;
+        container.key = key;
+        it = containers_.insert(it, std::move(container));
+    }
+
+    if (it->isBitmap()) {
+        uint64_t& word = it->bitmap[low >> 6];
+        uint64_t bit = uint64_t(1) << (low & 63);
+        if (word & bit) {
+            return;
+        }
+        word |= bit;
+    } else {
+        auto pos = std::lower_bound(it->array.begin(), it->array.end(), low);
+        if (pos != it->array.end() && *pos == low) {
+            return;
+        }
+        it->array.insert(pos, low);
+        if (it->array.size() > kArrayLimit) {
+            it->toBitmap();
+        }
+    }
+    it->cardinality++;
+    cardinality_++;
+}
+
+void ConeSet::unionContainer(Container& into, const Container& from) {
+    if (!into.isBitmap() && !from.isBitmap()) {
+        std::vector<uint16_t> merged;
+        merged.reserve(into.array.size() + from.array.size());
+        std::set_union(into.array.begin(), into.array.end(), from.array.begin(), from.array.end(),
+                       std::back_inserter(merged));
+        into.array.swap(merged);
+        into.cardinality = static_cast<uint32_t>(into.array.size());
+        if (into.array.size() > kArrayLimit) {
+            into.toBitmap();
+        }
+        return;
+    }
+
+    if (!into.isBitmap()) {
+        into.toBitmap();
+    }
+    if (from.isBitmap()) {
+        uint32_t count = 0;
+        for (size_t w = 0; w < kBitmapWords; w++) {
+            into.bitmap[w] |= from.bitmap[w];
+            count += static_cast<uint32_t>(__builtin_popcountll(into.bitmap[w]));
+        }
+        into.cardinality = count;
+    } else {
+        for (uint16_t low : from.array) {
+            uint64_t& word = into.bitmap[low >> 6];
+            uint64_t bit = uint64_t(1) << (low & 63);
+            into.cardinality += (word & bit) == 0;
+            word |= bit;
+        }
+    }
+}
+
+void ConeSet::unionWith(const ConeSet& other) {
+    std::vector<Container> merged;
+    merged.reserve(containers_.size() + other.containers_.size());
+    auto a = containers_.begin();
+    auto b = other.containers_.begin();
+    while (a != containers_.end() || b != other.containers_.end()) {
+        if (b == other.containers_.end() || (a != containers_.end() && a->key < b->key)) {
+            merged.push_back(std::move(*a++));
+        } else if (a == containers_.end() || b->key < a->key) {
+            merged.push_back(*b++);
+        } else {
+            unionContainer(*a, *b++);
+            merged.push_back(std::move(*a++));
+        }
+    }
+    containers_.swap(merged);
+
+    cardinality_ = 0;
+    for (const auto& container : containers_) {
+        cardinality_ += container.cardinality;
+    }
+}
+
+bool ConeSet::contains(uint32_t value) const {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value);
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) {
+        return false;
+    }
+    if (it->isBitmap()) {
+        return (it->bitmap[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(it->array.begin(), it->array.end(), low);
+}
+
+std::vector<uint32_t> ConeSet::toVector() const {
+    std::vector<uint32_t> values;
+    values.reserve(cardinality_);
+    for (const auto& container : containers_) {
+        uint32_t high = uint32_t(container.key) << 16;
+        if (!container.isBitmap()) {
+            for (uint16_t low : container.array) {
+                values.push_back(high | low);
+            }
+            continue;
+        }
+        for (size_t w = 0; w < kBitmapWords; w++) {
+            for (uint64_t word = container.bitmap[w]; word != 0; word &= word - 1) {
+                values.push_back(high | static_cast<uint32_t>(w * 64 + __builtin_ctzll(word)));
+            }
+        }
+    }
+    return values;
+}
+
+size_t ConeSet::getMemoryBytes() const {
+    size_t bytes = sizeof(ConeSet) + containers_.capacity() * sizeof(Container);
+    for (const auto& container : containers_) {
+        bytes += container.array.capacity() * sizeof(uint16_t) +
+                 container.bitmap.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
@@ -3,8 +3,15 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <queue>
 
 bool CSVOutput::writeRoutingTable(const ASGraph& graph, const std::string& filename) {
+    return writeRoutingTable(graph, filename, PrefixAliases());
+}
+
+bool CSVOutput::writeRoutingTable(const ASGraph& graph, const std::string& filename,
+                                  const PrefixAliases& aliases) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Could not open file " << filename << std::endl;
@@ -14,32 +21,235 @@ bool CSVOutput::writeRoutingTable(const ASGraph& graph, const std::string& filen
     // Write header
     file << "asn,prefix,as_path\n";
 
-    // Get all ASes in the graph
-    const auto& ases = graph.getAllASes();
-
     // For each AS, write its routing table
-    for (const auto& [asn, as_ptr] : ases) {
-        const auto& routing_table = as_ptr->getRoutingTable();
+    for (const auto& [asn, as_ptr] : graph.getAllASes()) {
+        writeASRows(file, graph, *as_ptr, aliases);
+    }
 
-        // Sort routing table entries by prefix for deterministic output
-        std::vector<std::pair<std::string, Announcement>> sorted_entries(
-            routing_table.begin(), routing_table.end()
-        );
-        std::sort(sorted_entries.begin(), sorted_entries.end(),
-            [](const auto& a, const auto& b) { return a.first < b.first; });
+    file.close();
+    return true;
+}
+
+bool CSVOutput::writeRoutingTable(const ASGraph& graph, const std::string& filename,
+                                  const PrefixAliases& aliases, const std::vector<uint32_t>& asns) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    file << "asn,prefix,as_path\n";
+
+    std::vector<uint32_t> sorted_asns(asns);
+    std::sort(sorted_asns.begin(), sorted_asns.end());
+    sorted_asns.erase(std::unique(sorted_asns.begin(), sorted_asns.end()), sorted_asns.end());
+    for (uint32_t asn : sorted_asns) {
+        if (const AS* as_ptr = graph.getAS(asn)) {
+            writeASRows(file, graph, *as_ptr, aliases);
+        }
+    }
+
+    file.close();
+    return true;
+}
+
+void CSVOutput::writeASRows(std::ostream& out, const ASGraph& graph, const AS& as,
+                            const PrefixAliases& aliases) {
+    // Derived ASes (see ASGraph::compactTopology) are materialized one at a time
+    std::unordered_map<std::string, Announcement> derived_table;
+    bool derived = graph.isDerived(as.getASN());
+    if (derived) {
+        derived_table = graph.getRoutingTable(as.getASN());
+    }
+    const auto& routing_table = derived ? derived_table : as.getRoutingTable();
+
+    // Fan simulated routes out to their aliases, then sort by prefix
+    // for deterministic output
+    std::vector<std::pair<const std::string*, const Announcement*>> sorted_entries;
+    sorted_entries.reserve(routing_table.size());
+    for (const auto& [prefix, announcement] : routing_table) {
+        auto alias = aliases.find(prefix);
+        if (alias == aliases.end()) {
+            sorted_entries.emplace_back(&prefix, &announcement);
+            continue;
+        }
+        for (const auto& member : alias->second) {
+            sorted_entries.emplace_back(&member, &announcement);
+        }
+    }
+    std::sort(sorted_entries.begin(), sorted_entries.end(),
+        [](const auto& a, const auto& b) { return *a.first < *b.first; });
+
+    for (const auto& [prefix, announcement] : sorted_entries) {
+        out << as.getASN() << ",";
+        out << *prefix << ",\"";
+        out << formatASPath(announcement->getASPath());
+        out << "\"\n";
+    }
+}
+
+bool CSVOutput::mergeRoutingTables(const std::vector<std::string>& parts,
+                                   const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    file << "asn,prefix,as_path\n";
+
+    // Head row of every part, keyed like the writers order them
+    struct Head {
+        uint32_t asn;
+        std::string prefix;
+        std::string line;
+        size_t part;
+    };
+    auto later = [](const Head& a, const Head& b) {
+        return a.asn != b.asn ? a.asn > b.asn : a.prefix > b.prefix;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
 
-        for (const auto& [prefix, announcement] : sorted_entries) {
-            file << asn << ",";
-            file << prefix << ",\"";
-            file << formatASPath(announcement.getASPath());
-            file << "\"\n";
+    std::vector<std::unique_ptr<std::ifstream>> inputs;
+    auto advance = [&](size_t part) {
+        std::string line;
+        if (!std::getline(*inputs[part], line) || line.empty()) {
+            return;
         }
+        size_t first = line.find(',');
+        size_t second = line.find(',', first + 1);
+        heads.push(Head{static_cast<uint32_t>(std::stoul(line.substr(0, first))),
+                        line.substr(first + 1, second - first - 1), line, part});
+    };
+
+    for (size_t part = 0; part < parts.size(); part++) {
+        inputs.push_back(std::make_unique<std::ifstream>(parts[part]));
+        std::string header;
+        if (!inputs.back()->is_open() || !std::getline(*inputs.back(), header)) {
+            std::cerr << "Error: Could not read " << parts[part] << std::endl;
+            return false;
+        }
+        advance(part);
+    }
+
+    while (!heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        file << head.line << "\n";
+        advance(head.part);
     }
 
     file.close();
     return true;
 }
 
+void CSVOutput::writeRouteChanges(std::ostream& out, const std::string& label,
+                                  const std::vector<RouteChange>& changes,
+                                  const PrefixAliases& aliases) {
+    // Changes arrive sorted by ASN, then simulated prefix
+    std::vector<std::pair<const std::string*, const RouteChange*>> rows;
+    auto flush = [&]() {
+        std::sort(rows.begin(), rows.end(),
+            [](const auto& a, const auto& b) { return *a.first < *b.first; });
+        for (const auto& [prefix, change] : rows) {
+            out << label << "," << change->asn << "," << *prefix << ",\""
+                << formatASPath(change->old_path) << "\",\"" << formatASPath(change->new_path)
+                << "\"\n";
+        }
+        rows.clear();
+    };
+
+    for (size_t i = 0; i < changes.size(); i++) {
+        if (i > 0 && changes[i].asn != changes[i - 1].asn) {
+            flush();
+        }
+        auto alias = aliases.find(changes[i].prefix);
+        if (alias == aliases.end()) {
+            rows.emplace_back(&changes[i].prefix, &changes[i]);
+            continue;
+        }
+        for (const auto& member : alias->second) {
+            rows.emplace_back(&member, &changes[i]);
+        }
+    }
+    flush();
+}
+
+bool CSVOutput::writeCustomerCones(const ASGraph& graph, const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    file << "# <asn> <customer cone members>\n";
+    std::string line;
+    for (const auto& [asn, as_ptr] : graph.getAllASes()) {
+        line = std::to_string(asn);
+        for (uint32_t member : graph.getCustomerCone(asn)) {
+            if (member != asn) {
+                line += ' ';
+                line += std::to_string(member);
+            }
+        }
+        line += '\n';
+        file << line;
+    }
+    return true;
+}
+
+size_t CSVOutput::writeAlternateRoutes(std::ostream& out, const ASGraph& graph,
+                                       const PrefixAliases& aliases,
+                                       const std::vector<uint32_t>& asns) {
+    std::vector<uint32_t> sorted_asns(asns);
+    if (sorted_asns.empty()) {
+        for (const auto& [asn, as_ptr] : graph.getAllASes()) {
+            sorted_asns.push_back(asn);
+        }
+    }
+    std::sort(sorted_asns.begin(), sorted_asns.end());
+    sorted_asns.erase(std::unique(sorted_asns.begin(), sorted_asns.end()), sorted_asns.end());
+
+    size_t covered = 0;
+    std::vector<std::pair<const std::string*, const std::string*>> sorted_entries;
+    for (uint32_t asn : sorted_asns) {
+        const AS* as_ptr = graph.getAS(asn);
+        if (!as_ptr || !as_ptr->hasAlternates()) {
+            continue;
+        }
+
+        // Alternates only exist where a route was installed
+        std::unordered_map<std::string, std::vector<AlternateRoute>> alternates;
+        sorted_entries.clear();
+        for (const auto& [prefix, ann] : as_ptr->getRoutingTable()) {
+            auto routes = as_ptr->getAlternates(prefix);
+            if (routes.empty()) {
+                continue;
+            }
+            auto it = alternates.emplace(prefix, std::move(routes)).first;
+            auto alias = aliases.find(prefix);
+            if (alias == aliases.end()) {
+                sorted_entries.emplace_back(&it->first, &it->first);
+                continue;
+            }
+            for (const auto& member : alias->second) {
+                sorted_entries.emplace_back(&member, &it->first);
+            }
+        }
+        std::sort(sorted_entries.begin(), sorted_entries.end(),
+            [](const auto& a, const auto& b) { return *a.first < *b.first; });
+
+        for (const auto& [prefix, simulated] : sorted_entries) {
+            const auto& routes = alternates.at(*simulated);
+            for (size_t rank = 0; rank < routes.size(); rank++) {
+                out << asn << "," << *prefix << "," << rank + 1 << ",\""
+                    << formatASPath(routes[rank].path) << "\"\n";
+            }
+        }
+        covered += sorted_entries.size();
+    }
+    return covered;
+}
+
 bool CSVOutput::writeASRoutingTable(const AS& as, const std::string& filename) {
     std::ofstream file(filename);
     if (!file.is_open()) {
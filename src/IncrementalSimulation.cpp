@@ -0,0 +1,745 @@
+#include "IncrementalSimulation.h"
+#include "RouteKey.h"
+#include "RouteSolver.h"
+#include "Scheduler.h"
+#include "TransitLoad.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <sstream>
+#include <unordered_set>
+
+/**
+ * The graph as a change would leave it, without modifying it: only the
+ * endpoints' neighbor lists (or the AS's ROV flag), and the ranks a new
+ * provider link raises, differ from graph_
+ */
+class IncrementalSimulation::View {
+public:
+    View(const IndexedGraph& graph, const Change* change) : graph_(graph) {
+        if (!change) {
+            return;
+        }
+        uint32_t a = graph.getIndex(change->asn);
+        if (change->kind == Change::Kind::SET_ROV) {
+            rov_ = a;
+            rov_drop_ = change->drop_invalid;
+            return;
+        }
+
+        uint32_t b = graph.getIndex(change->other);
+        a_ = a;
+        b_ = b;
+        a_lists_ = {graph.getProviders(a), graph.getCustomers(a), graph.getPeers(a)};
+        b_lists_ = {graph.getProviders(b), graph.getCustomers(b), graph.getPeers(b)};
+        switch (change->kind) {
+            case Change::Kind::REMOVE_LINK:
+                for (auto* list : {&a_lists_.providers, &a_lists_.customers, &a_lists_.peers}) {
+                    list->erase(std::remove(list->begin(), list->end(), b), list->end());
+                }
+                for (auto* list : {&b_lists_.providers, &b_lists_.customers, &b_lists_.peers}) {
+                    list->erase(std::remove(list->begin(), list->end(), a), list->end());
+                }
+                break;
+            case Change::Kind::ADD_PROVIDER_LINK:
+                insertSorted(a_lists_.customers, b);
+                insertSorted(b_lists_.providers, a);
+                if (auto raised = graph.getRaisedRanks(a, b)) {
+                    raised_ranks_.insert(raised->begin(), raised->end());
+                }
+                break;
+            case Change::Kind::ADD_PEER_LINK:
+                insertSorted(a_lists_.peers, b);
+                insertSorted(b_lists_.peers, a);
+                break;
+            case Change::Kind::SET_ROV:
+                break;
+        }
+    }
+
+    const std::vector<uint32_t>& getProviders(uint32_t v) const {
+        return v == a_ ? a_lists_.providers : v == b_ ? b_lists_.providers : graph_.getProviders(v);
+    }
+    const std::vector<uint32_t>& getCustomers(uint32_t v) const {
+        return v == a_ ? a_lists_.customers : v == b_ ? b_lists_.customers : graph_.getCustomers(v);
+    }
+    const std::vector<uint32_t>& getPeers(uint32_t v) const {
+        return v == a_ ? a_lists_.peers : v == b_ ? b_lists_.peers : graph_.getPeers(v);
+    }
+    bool getDropInvalid(uint32_t v) const {
+        return v == rov_ ? rov_drop_ : graph_.getDropInvalid(v);
+    }
+    int getRank(uint32_t v) const {
+        if (!raised_ranks_.empty()) {
+            auto it = raised_ranks_.find(v);
+            if (it != raised_ranks_.end()) {
+                return it->second;
+            }
+        }
+        return graph_.getRank(v);
+    }
+
+private:
+    struct Lists {
+        std::vector<uint32_t> providers;
+        std::vector<uint32_t> customers;
+        std::vector<uint32_t> peers;
+    };
+
+    const IndexedGraph& graph_;
+    uint32_t a_ = IndexedGraph::kNoIndex;
+    uint32_t b_ = IndexedGraph::kNoIndex;
+    Lists a_lists_;
+    Lists b_lists_;
+    uint32_t rov_ = IndexedGraph::kNoIndex;
+    bool rov_drop_ = false;
+    std::unordered_map<uint32_t, int> raised_ranks_;
+
+    static void insertSorted(std::vector<uint32_t>& list, uint32_t index) {
+        list.insert(std::lower_bound(list.begin(), list.end(), index), index);
+    }
+};
+
+namespace {
+
+// Neighbor a key's route was learned from (the AS itself for origins)
+uint32_t getHop(uint64_t key) {
+    return ~static_cast<uint32_t>(key);
+}
+
+// Keep the better of best and candidate, as RouteSolver::relax does
+void consider(uint64_t& best, uint64_t candidate, bool drop, uint64_t mask) {
+    if (drop && (candidate & RouteKey::kRankMask) == 0) {
+        return;  // ROV drops INVALID routes
+    }
+    if (best == 0 || (!RouteKey::isOrigin(best) && (candidate & mask) > (best & mask))) {
+        best = candidate;
+    }
+}
+
+// Route of v after the up stage: its own origin route or the best route of a
+// customer, given the customers' up-stage routes
+template <typename View, typename UpOf>
+uint64_t computeUp(const View& view, const std::unordered_map<uint32_t, uint64_t>& origins,
+                   uint32_t v, const UpOf& up_of) {
+    static const uint64_t customer_field = RouteKey::prefField(Relationship::CUSTOMER);
+    auto origin = origins.find(v);
+    uint64_t best = origin != origins.end() ? origin->second : 0;
+    bool drop = view.getDropInvalid(v);
+    uint64_t mask = RouteKey::compareMask(drop);
+    for (uint32_t c : view.getCustomers(v)) {
+        if (uint64_t route = up_of(c)) {
+            consider(best, RouteKey::extend(route, customer_field, c), drop, mask);
+        }
+    }
+    return best;
+}
+
+// Final route of v: its up-stage route, a peer's up-stage route or a
+// provider's final route
+template <typename View, typename UpOf, typename BestOf>
+uint64_t computeBest(const View& view, uint32_t v, const UpOf& up_of, const BestOf& best_of) {
+    static const uint64_t peer_field = RouteKey::prefField(Relationship::PEER);
+    static const uint64_t provider_field = RouteKey::prefField(Relationship::PROVIDER);
+    uint64_t best = up_of(v);
+    bool drop = view.getDropInvalid(v);
+    uint64_t mask = RouteKey::compareMask(drop);
+    for (uint32_t u : view.getPeers(v)) {
+        if (uint64_t route = up_of(u)) {
+            consider(best, RouteKey::extend(route, peer_field, u), drop, mask);
+        }
+    }
+    for (uint32_t p : view.getProviders(v)) {
+        if (uint64_t route = best_of(p)) {
+            consider(best, RouteKey::extend(route, provider_field, p), drop, mask);
+        }
+    }
+    return best;
+}
+
+bool parseASN(std::istringstream& in, uint32_t& asn) {
+    long long value = -1;
+    if (!(in >> value) || value < 0 || value > UINT32_MAX) {
+        return false;
+    }
+    asn = static_cast<uint32_t>(value);
+    return true;
+}
+
+}  // namespace
+
+std::optional<IncrementalSimulation::Change> IncrementalSimulation::Change::parse(
+    const std::string& line) {
+    std::istringstream in(line);
+    std::string verb;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    if (!(in >> verb) || !parseASN(in, a)) {
+        return std::nullopt;
+    }
+    if (verb == "rov-on" || verb == "rov-off") {
+        return setROV(a, verb == "rov-on");
+    }
+    if (!parseASN(in, b)) {
+        return std::nullopt;
+    }
+    if (verb == "remove-link") {
+        return removeLink(a, b);
+    }
+    if (verb == "add-provider-link") {
+        return addProviderLink(a, b);
+    }
+    if (verb == "add-peer-link") {
+        return addPeerLink(a, b);
+    }
+    return std::nullopt;
+}
+
+std::string IncrementalSimulation::Change::describe() const {
+    switch (kind) {
+        case Kind::REMOVE_LINK: return "remove-link " + std::to_string(asn) + " " + std::to_string(other);
+        case Kind::ADD_PROVIDER_LINK:
+            return "add-provider-link " + std::to_string(asn) + " " + std::to_string(other);
+        case Kind::ADD_PEER_LINK: return "add-peer-link " + std::to_string(asn) + " " + std::to_string(other);
+        case Kind::SET_ROV: return (drop_invalid ? "rov-on " : "rov-off ") + std::to_string(asn);
+    }
+    return "";
+}
+
+IncrementalSimulation::IncrementalSimulation(const ASGraph& graph,
+                                             const std::vector<InputAnnouncement>& announcements,
+                                             size_t num_threads)
+    : graph_(graph), validator_(graph.getROVValidator()) {
+    for (const auto& task : PrefixCostModel::buildTasks(announcements)) {
+        PrefixState state;
+        state.prefix = task.prefix;
+        state.announcements = task.announcements;
+        for (const auto& ann : task.announcements) {
+            uint32_t index = graph_.getIndex(ann.asn);
+            if (index != IndexedGraph::kNoIndex) {
+                // Duplicate announcement - first one wins, as in originatePrefix
+                auto [it, inserted] = state.origins.emplace(
+                    index, RouteKey::origin(validator_.validate(task.prefix, ann.asn), index));
+                state.contested |= (it->second & RouteKey::kRankMask) == 0;
+            }
+        }
+        prefix_index_.emplace(state.prefix, prefixes_.size());
+        prefixes_.push_back(std::move(state));
+    }
+
+    WorkStealingExecutor executor(std::max<size_t>(num_threads, 1));
+    std::vector<double> costs(prefixes_.size(), 1.0);
+    executor.run(costs, [this](size_t, size_t p) { solve(prefixes_[p]); });
+}
+
+void IncrementalSimulation::solve(PrefixState& state) const {
+    View view(graph_, nullptr);
+    state.up.assign(graph_.size(), 0);
+    state.best.assign(graph_.size(), 0);
+    auto up_of = [&state](uint32_t v) { return state.up[v]; };
+    auto best_of = [&state](uint32_t v) { return state.best[v]; };
+
+    // Ranks are the dependency order: customers before providers going up,
+    // providers before customers going down
+    const auto& ranks = graph_.getRanks();
+    for (const auto& rank : ranks) {
+        for (uint32_t v : rank) {
+            state.up[v] = computeUp(view, state.origins, v, up_of);
+        }
+    }
+    for (size_t r = ranks.size(); r-- > 0;) {
+        for (uint32_t v : ranks[r]) {
+            state.best[v] = computeBest(view, v, up_of, best_of);
+        }
+    }
+}
+
+std::vector<uint32_t> IncrementalSimulation::getSeeds(const Change& change) const {
+    std::vector<uint32_t> seeds{graph_.getIndex(change.asn)};
+    if (change.kind != Change::Kind::SET_ROV) {
+        seeds.push_back(graph_.getIndex(change.other));
+    }
+    return seeds;
+}
+
+IncrementalSimulation::PrefixDelta IncrementalSimulation::evaluatePrefix(
+    const PrefixState& state, const View& view, const std::vector<uint32_t>& seeds) const {
+    return sweepPrefix(state, view, seeds, seeds, ExportRule());
+}
+
+IncrementalSimulation::PrefixDelta IncrementalSimulation::sweepPrefix(
+    const PrefixState& state, const View& view, const std::vector<uint32_t>& up_seeds,
+    const std::vector<uint32_t>& best_seeds, const ExportRule& rule) const {
+    PrefixDelta delta;
+    auto up_of = [&](uint32_t v) {
+        auto it = delta.up.find(v);
+        return it != delta.up.end() ? it->second : state.up[v];
+    };
+    auto best_of = [&](uint32_t v) {
+        auto it = delta.best.find(v);
+        return it != delta.best.end() ? it->second : state.best[v];
+    };
+
+    // Marked routes: without a leaker, those whose route or path changed (a
+    // route that keeps its key still changes if the neighbor it extends
+    // did); with one, those running through the leak
+    bool mark_changes = rule.leaker == IndexedGraph::kNoIndex;
+    std::unordered_set<uint32_t> up_marked;
+    std::unordered_set<uint32_t> best_marked;
+
+    // What v hears from u's up-stage route (the leaker sends its final route
+    // to everyone but itself) and from u's final route. ASes on the leaked
+    // path drop routes through the leak (loop prevention).
+    auto leaks_to = [&](uint32_t v, uint32_t u) { return u == rule.leaker && v != rule.leaker; };
+    auto marked_up = [&](uint32_t v, uint32_t u) { return leaks_to(v, u) || up_marked.count(u) != 0; };
+    auto rejects = [&](uint32_t v) { return rule.rejecting && rule.rejecting->count(v) != 0; };
+    auto up_heard_by = [&](uint32_t v) {
+        return [&, v](uint32_t u) -> uint64_t {
+            if (rejects(v) && marked_up(v, u)) {
+                return 0;
+            }
+            return leaks_to(v, u) ? rule.leaked_key : up_of(u);
+        };
+    };
+    auto best_heard_by = [&](uint32_t v) {
+        return [&, v](uint32_t u) -> uint64_t {
+            return rejects(v) && best_marked.count(u) ? 0 : best_of(u);
+        };
+    };
+
+    using Entry = std::pair<int, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> up_queue;
+    std::priority_queue<Entry> best_queue;
+    std::unordered_set<uint32_t> up_queued;
+    std::unordered_set<uint32_t> best_queued;
+    auto push_up = [&](uint32_t v) {
+        if (up_queued.insert(v).second) {
+            up_queue.emplace(view.getRank(v), v);
+        }
+    };
+    auto push_best = [&](uint32_t v) {
+        if (best_queued.insert(v).second) {
+            best_queue.emplace(view.getRank(v), v);
+        }
+    };
+    for (uint32_t v : up_seeds) {
+        push_up(v);
+    }
+    for (uint32_t v : best_seeds) {
+        push_best(v);
+    }
+
+    // Up: ascending rank, so every customer is settled before its providers
+    while (!up_queue.empty()) {
+        uint32_t v = up_queue.top().second;
+        up_queue.pop();
+        uint64_t key = computeUp(view, state.origins, v, up_heard_by(v));
+        bool changed = key != state.up[v];
+        if (changed) {
+            delta.up[v] = key;
+        }
+        bool marked = (mark_changes && changed) ||
+                      (key != 0 && RouteKey::getRelationship(key) == Relationship::CUSTOMER &&
+                       marked_up(v, getHop(key)));
+        if (!changed && !marked) {
+            continue;
+        }
+        if (marked) {
+            up_marked.insert(v);
+        }
+        push_best(v);
+        for (uint32_t p : view.getProviders(v)) {
+            push_up(p);
+        }
+        for (uint32_t u : view.getPeers(v)) {
+            push_best(u);
+        }
+    }
+
+    // Down: descending rank, so every provider is settled before its customers
+    while (!best_queue.empty()) {
+        uint32_t v = best_queue.top().second;
+        best_queue.pop();
+        uint64_t key = computeBest(view, v, up_heard_by(v), best_heard_by(v));
+        bool changed = key != state.best[v];
+        if (changed) {
+            delta.best[v] = key;
+        }
+        bool marked = mark_changes && changed;
+        if (!marked && key != 0) {
+            switch (RouteKey::getRelationship(key)) {
+                case Relationship::ORIGIN:
+                case Relationship::CUSTOMER:
+                    marked = up_marked.count(v) != 0;  // The up-stage route itself
+                    break;
+                case Relationship::PEER:
+                    marked = marked_up(v, getHop(key));
+                    break;
+                default:
+                    marked = best_marked.count(getHop(key)) != 0;
+                    break;
+            }
+        }
+        if (!changed && !marked) {
+            continue;
+        }
+        if (marked) {
+            best_marked.insert(v);
+            delta.changed.push_back(v);
+        }
+        for (uint32_t c : view.getCustomers(v)) {
+            push_best(c);
+        }
+    }
+
+    return delta;
+}
+
+bool IncrementalSimulation::isApplicable(const Change& change) const {
+    uint32_t a = graph_.getIndex(change.asn);
+    if (a == IndexedGraph::kNoIndex) {
+        return false;
+    }
+    if (change.kind == Change::Kind::SET_ROV) {
+        return true;
+    }
+
+    uint32_t b = graph_.getIndex(change.other);
+    if (b == IndexedGraph::kNoIndex || a == b) {
+        return false;
+    }
+    switch (change.kind) {
+        case Change::Kind::REMOVE_LINK: return graph_.hasLink(a, b);
+        case Change::Kind::ADD_PROVIDER_LINK:
+            return !graph_.hasLink(a, b) && graph_.getRaisedRanks(a, b).has_value();
+        default: return !graph_.hasLink(a, b);
+    }
+}
+
+std::vector<IncrementalSimulation::RouteChange> IncrementalSimulation::evaluate(
+    const Change& change) const {
+    std::vector<RouteChange> changes;
+    if (!isApplicable(change)) {
+        return changes;
+    }
+
+    View view(graph_, &change);
+    auto seeds = getSeeds(change);
+    for (const auto& state : prefixes_) {
+        if (!isAffected(state, change)) {
+            continue;
+        }
+        PrefixDelta delta = evaluatePrefix(state, view, seeds);
+        for (uint32_t v : delta.changed) {
+            changes.push_back(RouteChange{graph_.getASN(v), state.prefix,
+                                          buildPath(state, nullptr, v), buildPath(state, &delta, v)});
+        }
+    }
+
+    std::sort(changes.begin(), changes.end(), [](const RouteChange& a, const RouteChange& b) {
+        return a.asn != b.asn ? a.asn < b.asn : a.prefix < b.prefix;
+    });
+    return changes;
+}
+
+size_t IncrementalSimulation::countChanges(const Change& change) const {
+    if (!isApplicable(change)) {
+        return 0;
+    }
+
+    View view(graph_, &change);
+    auto seeds = getSeeds(change);
+    size_t count = 0;
+    for (const auto& state : prefixes_) {
+        if (isAffected(state, change)) {
+            count += evaluatePrefix(state, view, seeds).changed.size();
+        }
+    }
+    return count;
+}
+
+namespace {
+
+bool isInvalidRoute(uint64_t key) {
+    return key != 0 && (key & RouteKey::kRankMask) == 0;
+}
+
+}  // namespace
+
+int64_t IncrementalSimulation::getInvalidRouteDelta(const Change& change) const {
+    if (!isApplicable(change)) {
+        return 0;
+    }
+
+    // Only keys that change can flip between invalid and not
+    View view(graph_, &change);
+    auto seeds = getSeeds(change);
+    int64_t delta = 0;
+    for (const auto& state : prefixes_) {
+        if (!isAffected(state, change)) {
+            continue;
+        }
+        for (const auto& [v, key] : evaluatePrefix(state, view, seeds).best) {
+            delta += int64_t(isInvalidRoute(key)) - int64_t(isInvalidRoute(state.best[v]));
+        }
+    }
+    return delta;
+}
+
+size_t IncrementalSimulation::countInvalidRoutes() const {
+    size_t count = 0;
+    for (const auto& state : prefixes_) {
+        if (state.contested) {
+            count += std::count_if(state.best.begin(), state.best.end(), isInvalidRoute);
+        }
+    }
+    return count;
+}
+
+std::vector<uint32_t> IncrementalSimulation::getInvalidRouteHolders() const {
+    std::vector<uint8_t> holds(graph_.size(), 0);
+    for (const auto& state : prefixes_) {
+        if (!state.contested) {
+            continue;
+        }
+        for (uint32_t v = 0; v < graph_.size(); v++) {
+            holds[v] |= isInvalidRoute(state.best[v]) || isInvalidRoute(state.up[v]);
+        }
+    }
+
+    std::vector<uint32_t> asns;
+    for (uint32_t v = 0; v < graph_.size(); v++) {
+        if (holds[v] && !graph_.getDropInvalid(v)) {
+            asns.push_back(graph_.getASN(v));
+        }
+    }
+    return asns;
+}
+
+std::vector<IncrementalSimulation::LinkLoad> IncrementalSimulation::getLinkLoads(
+    size_t num_threads) const {
+    WorkStealingExecutor executor(std::max<size_t>(num_threads, 1));
+    std::vector<NextHopTreeLoad> loads(executor.getWorkerCount(), NextHopTreeLoad(graph_.size()));
+    std::vector<std::vector<NextHopTreeLoad::Route>> trees(executor.getWorkerCount());
+    std::vector<double> costs(prefixes_.size(), 1.0);
+    executor.run(costs, [&](size_t worker, size_t p) {
+        const PrefixState& state = prefixes_[p];
+        auto& tree = trees[worker];
+        tree.clear();
+        for (uint32_t v = 0; v < graph_.size(); v++) {
+            uint64_t key = state.best[v];
+            if (key == 0) {
+                continue;
+            }
+            uint32_t hop = RouteKey::getRelationship(key) == Relationship::ORIGIN
+                ? NextHopTreeLoad::kNoHop
+                : getHop(key);
+            tree.push_back(NextHopTreeLoad::Route{v, hop, RouteKey::getPathLength(key)});
+        }
+        loads[worker].addTree(tree, 1);
+    });
+
+    std::unordered_map<uint64_t, uint64_t> total;
+    for (const auto& load : loads) {
+        for (const auto& [link, routes] : load.getLinkPaths()) {
+            total[link] += routes;
+        }
+    }
+    std::vector<LinkLoad> links;
+    links.reserve(total.size());
+    for (const auto& [link, routes] : total) {
+        uint32_t v = static_cast<uint32_t>(link >> 32);
+        uint32_t hop = static_cast<uint32_t>(link);
+        const auto& providers = graph_.getProviders(v);
+        const auto& customers = graph_.getCustomers(v);
+        Relationship relationship = std::binary_search(providers.begin(), providers.end(), hop)
+            ? Relationship::PROVIDER
+            : std::binary_search(customers.begin(), customers.end(), hop) ? Relationship::CUSTOMER
+                                                                          : Relationship::PEER;
+        links.push_back(LinkLoad{graph_.getASN(v), graph_.getASN(hop), relationship, routes});
+    }
+    std::sort(links.begin(), links.end(), [](const LinkLoad& a, const LinkLoad& b) {
+        return a.asn != b.asn ? a.asn < b.asn : a.next_hop < b.next_hop;
+    });
+    return links;
+}
+
+std::vector<IncrementalSimulation::RouteChange> IncrementalSimulation::apply(const Change& change) {
+    std::vector<RouteChange> changes;
+    if (!isApplicable(change)) {
+        return changes;
+    }
+
+    std::vector<PrefixDelta> deltas;
+    deltas.reserve(prefixes_.size());
+    {
+        View view(graph_, &change);
+        auto seeds = getSeeds(change);
+        for (const auto& state : prefixes_) {
+            deltas.push_back(isAffected(state, change) ? evaluatePrefix(state, view, seeds)
+                                                       : PrefixDelta());
+        }
+    }
+
+    // Paths before and after need the old keys, so report before committing
+    for (size_t p = 0; p < prefixes_.size(); p++) {
+        for (uint32_t v : deltas[p].changed) {
+            changes.push_back(RouteChange{graph_.getASN(v), prefixes_[p].prefix,
+                                          buildPath(prefixes_[p], nullptr, v),
+                                          buildPath(prefixes_[p], &deltas[p], v)});
+        }
+    }
+    for (size_t p = 0; p < prefixes_.size(); p++) {
+        for (const auto& [v, key] : deltas[p].up) {
+            prefixes_[p].up[v] = key;
+        }
+        for (const auto& [v, key] : deltas[p].best) {
+            prefixes_[p].best[v] = key;
+        }
+    }
+    applyToGraph(change);
+
+    std::sort(changes.begin(), changes.end(), [](const RouteChange& a, const RouteChange& b) {
+        return a.asn != b.asn ? a.asn < b.asn : a.prefix < b.prefix;
+    });
+    return changes;
+}
+
+size_t IncrementalSimulation::verify(size_t num_threads) const {
+    WorkStealingExecutor executor(std::max<size_t>(num_threads, 1));
+    std::vector<RouteSolver> solvers;
+    solvers.reserve(executor.getWorkerCount());
+    for (size_t w = 0; w < executor.getWorkerCount(); w++) {
+        solvers.emplace_back(graph_, validator_);
+    }
+    std::vector<size_t> mismatches(executor.getWorkerCount(), 0);
+    std::vector<double> costs(prefixes_.size(), 1.0);
+    executor.run(costs, [&](size_t worker, size_t p) {
+        const PrefixState& state = prefixes_[p];
+        RouteSolver& solver = solvers[worker];
+        solver.compute(PrefixTask{state.prefix, state.announcements});
+
+        // Reached ASes must hold the same key, and no other AS a route
+        size_t unreached = std::count_if(state.best.begin(), state.best.end(),
+                                         [](uint64_t key) { return key != 0; });
+        for (uint32_t v : solver.getReached()) {
+            mismatches[worker] += solver.getKey(v) != state.best[v];
+            unreached -= state.best[v] != 0;
+        }
+        mismatches[worker] += unreached;
+    });
+
+    size_t total = 0;
+    for (size_t count : mismatches) {
+        total += count;
+    }
+    return total;
+}
+
+std::vector<uint32_t> IncrementalSimulation::getLeakCandidates(const std::string& prefix) const {
+    std::vector<uint32_t> asns;
+    auto it = prefix_index_.find(prefix);
+    if (it == prefix_index_.end()) {
+        return asns;
+    }
+    const PrefixState& state = prefixes_[it->second];
+    for (uint32_t v = 0; v < graph_.size(); v++) {
+        uint64_t key = state.best[v];
+        if (key != 0 && key != state.up[v]) {
+            asns.push_back(graph_.getASN(v));
+        }
+    }
+    return asns;
+}
+
+size_t IncrementalSimulation::countLeakAdopters(uint32_t leaker, const std::string& prefix) const {
+    auto it = prefix_index_.find(prefix);
+    uint32_t leak = graph_.getIndex(leaker);
+    if (it == prefix_index_.end() || leak == IndexedGraph::kNoIndex) {
+        return 0;
+    }
+    const PrefixState& state = prefixes_[it->second];
+    uint64_t leak_key = state.best[leak];
+    if (leak_key == 0 || leak_key == state.up[leak]) {
+        return 0;  // Customer and origin routes go to providers and peers anyway
+    }
+
+    // The leaked route's own ASes (the leaker included) would see a loop
+    std::unordered_set<uint32_t> on_path;
+    for (uint32_t asn : buildPath(state, nullptr, leak)) {
+        on_path.insert(graph_.getIndex(asn));
+    }
+
+    // The leaker's providers hear its final route as a customer route and
+    // its peers as a peer route; baseline routes never run through it
+    ExportRule rule;
+    rule.leaker = leak;
+    rule.leaked_key = leak_key;
+    rule.rejecting = &on_path;
+    return sweepPrefix(state, View(graph_, nullptr), graph_.getProviders(leak), graph_.getPeers(leak),
+                       rule)
+        .changed.size();
+}
+
+bool IncrementalSimulation::applyToGraph(const Change& change) {
+    uint32_t a = graph_.getIndex(change.asn);
+    switch (change.kind) {
+        case Change::Kind::REMOVE_LINK: return graph_.removeLink(a, graph_.getIndex(change.other));
+        case Change::Kind::ADD_PROVIDER_LINK:
+            return graph_.addProviderLink(a, graph_.getIndex(change.other));
+        case Change::Kind::ADD_PEER_LINK: return graph_.addPeerLink(a, graph_.getIndex(change.other));
+        case Change::Kind::SET_ROV:
+            graph_.setDropInvalid(a, change.drop_invalid);
+            return true;
+    }
+    return false;
+}
+
+std::vector<uint32_t> IncrementalSimulation::buildPath(const PrefixState& state,
+                                                       const PrefixDelta* delta,
+                                                       uint32_t index) const {
+    auto lookup = [delta](const std::unordered_map<uint32_t, uint64_t> PrefixDelta::*field,
+                          const std::vector<uint64_t>& base, uint32_t v) {
+        if (delta) {
+            auto it = (delta->*field).find(v);
+            if (it != (delta->*field).end()) {
+                return it->second;
+            }
+        }
+        return base[v];
+    };
+    auto best_of = [&](uint32_t v) { return lookup(&PrefixDelta::best, state.best, v); };
+
+    std::vector<uint32_t> path;
+    if (best_of(index) == 0) {
+        return path;
+    }
+    RouteKey::buildPath(graph_, index,
+        [&](uint32_t v) {
+            uint64_t key = best_of(v);
+            return std::make_pair(key, getHop(key));
+        },
+        [&](uint32_t v) {
+            uint64_t key = lookup(&PrefixDelta::up, state.up, v);
+            return std::make_pair(key, getHop(key));
+        },
+        path);
+    return path;
+}
+
+void IncrementalSimulation::installRoutes(ASGraph& graph) const {
+    for (const auto& state : prefixes_) {
+        for (uint32_t v = 0; v < graph_.size(); v++) {
+            uint64_t key = state.best[v];
+            if (key == 0) {
+                continue;
+            }
+            std::vector<uint32_t> path = buildPath(state, nullptr, v);
+            Announcement ann(path.back(), state.prefix);
+            ann.setASPath(path);
+            ann.setRelationship(RouteKey::getRelationship(key));
+            ann.setROVState(RouteKey::getROVState(key));
+            graph.getAS(graph_.getASN(v))->installRoute(ann);
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#include "IndexedGraph.h"
+#include <algorithm>
+
+IndexedGraph::IndexedGraph(const ASGraph& graph) {
+    const auto& ases = graph.getAllASes();
+    asns_.reserve(ases.size());
+    index_.reserve(ases.size());
+
+    // std::map iterates in ASN order, which fixes the dense numbering
+    for (const auto& [asn, as_ptr] : ases) {
+        index_[asn] = static_cast<uint32_t>(asns_.size());
+        asns_.push_back(asn);
+    }
+
+    auto translate = [this](const std::vector<AS*>& neighbors) {
+        std::vector<uint32_t> result;
+        result.reserve(neighbors.size());
+        for (const AS* neighbor : neighbors) {
+            // Inactive ASes (compacted or pruned) are left unconnected
+            if (neighbor->isActive()) {
+                result.push_back(index_.at(neighbor->getASN()));
+            }
+        }
+        return result;
+    };
+
+    providers_.reserve(ases.size());
+    customers_.reserve(ases.size());
+    peers_.reserve(ases.size());
+    rank_.reserve(ases.size());
+    drop_invalid_.reserve(ases.size());
+    for (const auto& [asn, as_ptr] : ases) {
+        providers_.push_back(translate(as_ptr->getProviders()));
+        customers_.push_back(translate(as_ptr->getCustomers()));
+        peers_.push_back(translate(as_ptr->getPeers()));
+        rank_.push_back(as_ptr->getPropagationRank());
+        drop_invalid_.push_back(as_ptr->getDropInvalid() ? 1 : 0);
+    }
+
+    for (const auto& rank : graph.getPropagationRanks()) {
+        ranks_.push_back(translate(rank));
+    }
+}
+
+uint32_t IndexedGraph::getIndex(uint32_t asn) const {
+    auto it = index_.find(asn);
+    return it != index_.end() ? it->second : kNoIndex;
+}
+
+namespace {
+bool eraseSorted(std::vector<uint32_t>& list, uint32_t index) {
+    auto it = std::lower_bound(list.begin(), list.end(), index);
+    if (it == list.end() || *it != index) {
+        return false;
+    }
+    list.erase(it);
+    return true;
+}
+
+void insertSorted(std::vector<uint32_t>& list, uint32_t index) {
+    list.insert(std::lower_bound(list.begin(), list.end(), index), index);
+}
+}  // namespace
+
+bool IndexedGraph::hasLink(uint32_t a, uint32_t b) const {
+    for (const auto* list : {&providers_[a], &customers_[a], &peers_[a]}) {
+        if (std::binary_search(list->begin(), list->end(), b)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IndexedGraph::removeLink(uint32_t a, uint32_t b) {
+    if (eraseSorted(providers_[a], b)) {
+        return eraseSorted(customers_[b], a);
+    }
+    if (eraseSorted(customers_[a], b)) {
+        return eraseSorted(providers_[b], a);
+    }
+    return eraseSorted(peers_[a], b) && eraseSorted(peers_[b], a);
+}
+
+std::optional<std::vector<std::pair<uint32_t, int>>> IndexedGraph::getRaisedRanks(
+    uint32_t provider, uint32_t customer) const {
+    std::vector<std::pair<uint32_t, int>> raised;
+    if (rank_[provider] > rank_[customer]) {
+        return raised;
+    }
+
+    // Same rule as ASGraph::assignRanksHelper: an AS ranks above every
+    // customer. Raising stops where a provider already ranks high enough;
+    // reaching the customer means it is one of its own providers.
+    std::unordered_map<uint32_t, int> ranks{{provider, rank_[customer] + 1}};
+    std::vector<uint32_t> stack{provider};
+    while (!stack.empty()) {
+        uint32_t v = stack.back();
+        stack.pop_back();
+        int rank = ranks[v];
+        for (uint32_t p : providers_[v]) {
+            if (p == customer) {
+                return std::nullopt;
+            }
+            auto it = ranks.find(p);
+            int current = it != ranks.end() ? it->second : rank_[p];
+            if (current <= rank) {
+                ranks[p] = rank + 1;
+                stack.push_back(p);
+            }
+        }
+    }
+
+    raised.assign(ranks.begin(), ranks.end());
+    std::sort(raised.begin(), raised.end());
+    return raised;
+}
+
+bool IndexedGraph::addProviderLink(uint32_t provider, uint32_t customer) {
+    if (provider == customer || hasLink(provider, customer)) {
+        return false;
+    }
+    auto raised = getRaisedRanks(provider, customer);
+    if (!raised) {
+        return false;
+    }
+    for (const auto& [index, rank] : *raised) {
+        eraseSorted(ranks_[rank_[index]], index);
+        if (static_cast<size_t>(rank) >= ranks_.size()) {
+            ranks_.resize(rank + 1);
+        }
+        insertSorted(ranks_[rank], index);
+        rank_[index] = rank;
+    }
+    insertSorted(customers_[provider], customer);
+    insertSorted(providers_[customer], provider);
+    return true;
+}
+
+bool IndexedGraph::addPeerLink(uint32_t a, uint32_t b) {
+    if (a == b || hasLink(a, b)) {
+        return false;
+    }
+    insertSorted(peers_[a], b);
+    insertSorted(peers_[b], a);
+    return true;
+}
@@ -0,0 +1,66 @@
+#include "LinkFailureSweep.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <utility>
+
+LinkFailureSweep::LinkFailureSweep(const IncrementalSimulation& simulation, size_t num_threads)
+    : simulation_(simulation), executor_(num_threads) {}
+
+std::vector<LinkFailureSweep::Link> LinkFailureSweep::selectLinks(size_t k) const {
+    // Fold both directions of each link together
+    std::map<std::pair<uint32_t, uint32_t>, Link> undirected;
+    for (const auto& load : simulation_.getLinkLoads(executor_.getWorkerCount())) {
+        Link link{load.asn, load.next_hop, load.relationship == Relationship::PEER, 0};
+        if (load.relationship == Relationship::PROVIDER ||
+            (link.peer && load.next_hop < load.asn)) {
+            std::swap(link.a, link.b);
+        }
+        auto it = undirected.emplace(std::make_pair(link.a, link.b), link).first;
+        it->second.load += load.routes;
+    }
+
+    std::vector<Link> links;
+    links.reserve(undirected.size());
+    for (const auto& [ends, link] : undirected) {
+        links.push_back(link);
+    }
+    std::stable_sort(links.begin(), links.end(),
+                     [](const Link& x, const Link& y) { return x.load > y.load; });
+    if (k > 0 && k < links.size()) {
+        links.resize(k);
+    }
+    return links;
+}
+
+std::vector<LinkFailureSweep::Link> LinkFailureSweep::run(std::vector<Link> links) {
+    // Heavier links invalidate larger subtrees
+    std::vector<double> costs(links.size());
+    for (size_t i = 0; i < links.size(); i++) {
+        costs[i] = static_cast<double>(links[i].load);
+    }
+    executor_.run(costs, [&](size_t, size_t i) {
+        auto change = IncrementalSimulation::Change::removeLink(links[i].a, links[i].b);
+        links[i].changed = simulation_.countChanges(change);
+    });
+    std::stable_sort(links.begin(), links.end(), [](const Link& x, const Link& y) {
+        return x.changed != y.changed ? x.changed > y.changed : x.load > y.load;
+    });
+    return links;
+}
+
+bool LinkFailureSweep::writeCSV(const std::string& filename, const std::vector<Link>& links) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    file << "rank,asn_a,asn_b,link,transit_load,changed_routes\n";
+    for (size_t i = 0; i < links.size(); i++) {
+        file << i + 1 << "," << links[i].a << "," << links[i].b << ","
+             << (links[i].peer ? "peer" : "provider-customer") << "," << links[i].load << ","
+             << links[i].changed << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,172 @@
+#include "PathMatrix.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'A', 'S', 'P', 'A', 'T', 'H', 'M', '1'};
+constexpr size_t kHeaderWords = 4;  // Magic (two words), num_ases, num_origins
+
+// File size for the given dimensions; false if the header cannot hold them
+// or the size overflows
+bool getFileBytes(size_t num_ases, size_t num_origins, size_t& bytes) {
+    constexpr size_t kMaxWords = static_cast<size_t>(INT64_MAX) / sizeof(uint32_t);
+    if (num_ases > UINT32_MAX || num_origins > UINT32_MAX ||
+        (num_origins != 0 && num_ases > kMaxWords / num_origins)) {
+        return false;
+    }
+    size_t words = num_ases * num_origins;
+    if (kHeaderWords + num_ases + num_origins > kMaxWords - words) {
+        return false;
+    }
+    bytes = (kHeaderWords + num_ases + num_origins + words) * sizeof(uint32_t);
+    return true;
+}
+
+}  // namespace
+
+PathMatrix::~PathMatrix() {
+    close();
+}
+
+bool PathMatrix::create(const std::string& filename, const std::vector<uint32_t>& asns,
+                        const std::vector<uint32_t>& origins) {
+    close();
+    num_ases_ = asns.size();
+    num_origins_ = origins.size();
+    if (!getFileBytes(num_ases_, num_origins_, bytes_)) {
+        std::cerr << "Error: Path matrix too large: " << num_ases_ << " ASes x " << num_origins_
+                  << " origins" << std::endl;
+        return false;
+    }
+
+    // Reserve the blocks up front: writing through the mapping into a sparse
+    // file that runs out of space raises SIGBUS instead of an error
+    fd_ = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Error: Could not create path matrix " << filename << std::endl;
+        return false;
+    }
+    int error = posix_fallocate(fd_, 0, static_cast<off_t>(bytes_));
+    if (error != 0) {
+        std::cerr << "Error: Could not allocate " << bytes_ << " bytes for path matrix " << filename
+                  << ": " << std::strerror(error) << std::endl;
+        close();
+        return false;
+    }
+    if (!map(true)) {
+        return false;
+    }
+
+    uint32_t* words = static_cast<uint32_t*>(data_);
+    std::memcpy(words, kMagic, sizeof(kMagic));
+    words[2] = static_cast<uint32_t>(num_ases_);
+    words[3] = static_cast<uint32_t>(num_origins_);
+    std::copy(asns.begin(), asns.end(), words + kHeaderWords);
+    std::copy(origins.begin(), origins.end(), words + kHeaderWords + num_ases_);
+    buildIndex();
+    return true;
+}
+
+bool PathMatrix::open(const std::string& filename) {
+    close();
+    fd_ = ::open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd_ < 0 || fstat(fd_, &info) != 0) {
+        std::cerr << "Error: Could not open path matrix " << filename << std::endl;
+        close();
+        return false;
+    }
+    bytes_ = static_cast<size_t>(info.st_size);
+    if (bytes_ < kHeaderWords * sizeof(uint32_t) || !map(false)) {
+        std::cerr << "Error: Not a path matrix: " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    const uint32_t* words = static_cast<const uint32_t*>(data_);
+    num_ases_ = words[2];
+    num_origins_ = words[3];
+    size_t expected = 0;
+    if (std::memcmp(words, kMagic, sizeof(kMagic)) != 0 ||
+        !getFileBytes(num_ases_, num_origins_, expected) || bytes_ != expected) {
+        std::cerr << "Error: Not a path matrix: " << filename << std::endl;
+        close();
+        return false;
+    }
+    buildIndex();
+    return true;
+}
+
+bool PathMatrix::map(bool writable) {
+    data_ = mmap(nullptr, bytes_, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        std::cerr << "Error: Could not map path matrix (" << bytes_ << " bytes)" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PathMatrix::buildIndex() {
+    uint32_t* words = static_cast<uint32_t*>(data_);
+    asns_ = words + kHeaderWords;
+    origins_ = asns_ + num_ases_;
+    hops_ = words + kHeaderWords + num_ases_ + num_origins_;
+    index_.clear();
+    slots_.clear();
+    for (size_t v = 0; v < num_ases_; v++) {
+        index_[asns_[v]] = static_cast<uint32_t>(v);
+    }
+    for (size_t slot = 0; slot < num_origins_; slot++) {
+        slots_[origins_[slot]] = slot;
+    }
+}
+
+bool PathMatrix::close() {
+    bool ok = true;
+    if (data_) {
+        ok = msync(data_, bytes_, MS_SYNC) == 0;
+        munmap(data_, bytes_);
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    asns_ = origins_ = nullptr;
+    hops_ = nullptr;
+    return ok;
+}
+
+std::vector<uint32_t> PathMatrix::getPath(uint32_t source, uint32_t origin) const {
+    std::vector<uint32_t> path;
+    auto from = index_.find(source);
+    auto to = index_.find(origin);
+    if (from == index_.end() || to == index_.end()) {
+        return path;
+    }
+    auto slot = slots_.find(to->second);
+    if (slot == slots_.end()) {
+        return path;
+    }
+
+    const uint32_t* column = hops_ + slot->second * num_ases_;
+    uint32_t v = from->second;
+    while (column[v] != kNoRoute && path.size() < num_ases_) {
+        path.push_back(asns_[v]);
+        if (column[v] == v) {
+            return path;  // Reached the origin
+        }
+        v = column[v];
+    }
+    path.clear();  // No route, or a corrupt (looping) column
+    return path;
+}
@@ -2,37 +2,6 @@
 #include "AS.h"
 #include <algorithm>
 
-bool Policy::shouldExport(Relationship learnedFrom, Relationship exportTo) {
-    // Always export originated routes
-    if (learnedFrom == Relationship::ORIGIN) {
-        return true;
-    }
-    
-    // Always export to customers (they pay us)
-    if (exportTo == Relationship::CUSTOMER) {
-        return true;
-    }
-    
-    // Export customer routes to peers and providers
-    if (learnedFrom == Relationship::CUSTOMER) {
-        return true;
-    }
-    
-    // Don't export peer routes to other peers or providers (valley-free)
-    if (learnedFrom == Relationship::PEER && 
-        (exportTo == Relationship::PEER || exportTo == Relationship::PROVIDER)) {
-        return false;
-    }
-    
-    // Don't export provider routes to peers or other providers (valley-free)
-    if (learnedFrom == Relationship::PROVIDER &&
-        (exportTo == Relationship::PEER || exportTo == Relationship::PROVIDER)) {
-        return false;
-    }
-    
-    return true;
-}
-
 int Policy::getLocalPreference(Relationship rel) {
     switch (rel) {
         case Relationship::ORIGIN:
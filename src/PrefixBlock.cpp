@@ -0,0 +1,254 @@
+#include "PrefixBlock.h"
+#include "RouteKey.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BGP_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * Offer neighbor 'from' routes (src lanes) to one AS (cur/hop lanes).
+ * A lane takes the candidate when the neighbor exports it over this edge
+ * (its local pref is at least min_export), ROV does not reject it, and it
+ * beats the current route, which is not the AS's own origination.
+ * compare_mask hides the ROV rank for ASes that do not run ROV, matching
+ * AS::isBetterPath.
+ */
+template <size_t W>
+inline void relaxLanes(uint64_t* cur, uint32_t* hop, const uint64_t* src,
+                       uint64_t pref_field, uint64_t min_export, uint32_t from,
+                       uint64_t compare_mask, bool drop_invalid) {
+    using namespace RouteKey;
+    for (size_t lane = 0; lane < W; lane++) {
+        const uint64_t route = src[lane];
+        const uint64_t candidate = extend(route, pref_field, from);
+        const bool exportable = (route & kPrefMask) >= min_export;
+        const bool rejected = drop_invalid & ((route & kRankMask) == 0);
+        const bool better = exportable & !rejected & !isOrigin(cur[lane]) &
+                            ((candidate & compare_mask) > (cur[lane] & compare_mask));
+        cur[lane] = better ? candidate : cur[lane];
+        hop[lane] = better ? from : hop[lane];
+    }
+}
+
+#ifdef BGP_HAVE_AVX2_KERNEL
+/**
+ * relaxLanes on four lanes per AVX2 register. Keys are unsigned but AVX2
+ * only compares signed 64-bit lanes, so the best-route compare flips the
+ * sign bit first (as in BestPathSelector::argmax); the masked local pref
+ * stays below bit 62 and compares as is.
+ */
+template <size_t W>
+__attribute__((target("avx2")))
+void relaxLanesAVX2(uint64_t* cur, uint32_t* hop, const uint64_t* src,
+                    uint64_t pref_field, uint64_t min_export, uint32_t from,
+                    uint64_t compare_mask, bool drop_invalid) {
+    using namespace RouteKey;
+    const __m256i rank_mask = _mm256_set1_epi64x(static_cast<long long>(kRankMask));
+    const __m256i pref_mask = _mm256_set1_epi64x(static_cast<long long>(kPrefMask));
+    const __m256i length_mask = _mm256_set1_epi64x(static_cast<long long>(kLengthMask));
+    const __m256i length_unit = _mm256_set1_epi64x(static_cast<long long>(kLengthUnit));
+    const __m256i edge = _mm256_set1_epi64x(
+        static_cast<long long>(pref_field | static_cast<uint32_t>(~from)));
+    const __m256i below_export = _mm256_set1_epi64x(
+        static_cast<long long>(min_export - 1));  // min_export is never 0
+    const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(compare_mask));
+    const __m256i origin = _mm256_set1_epi64x(static_cast<long long>(prefField(Relationship::ORIGIN)));
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i drop = _mm256_set1_epi64x(drop_invalid ? -1 : 0);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const __m128i from_lanes = _mm_set1_epi32(static_cast<int>(from));
+
+    for (size_t lane = 0; lane < W; lane += 4) {
+        const __m256i route = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + lane));
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + lane));
+        const __m256i candidate = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(route, rank_mask), edge),
+            _mm256_sub_epi64(_mm256_and_si256(route, length_mask), length_unit));
+        const __m256i exportable = _mm256_cmpgt_epi64(_mm256_and_si256(route, pref_mask), below_export);
+        const __m256i rejected = _mm256_and_si256(
+            drop, _mm256_cmpeq_epi64(_mm256_and_si256(route, rank_mask), zero));
+        const __m256i originated = _mm256_cmpeq_epi64(_mm256_and_si256(current, pref_mask), origin);
+        const __m256i better = _mm256_cmpgt_epi64(
+            _mm256_xor_si256(_mm256_and_si256(candidate, mask), bias),
+            _mm256_xor_si256(_mm256_and_si256(current, mask), bias));
+        const __m256i take = _mm256_andnot_si256(_mm256_or_si256(rejected, originated),
+                                                 _mm256_and_si256(exportable, better));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(cur + lane),
+                            _mm256_blendv_epi8(current, candidate, take));
+
+        // Next hops are 32-bit: narrow the lane mask to its low halves
+        const __m128i take_hops = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(take, low_halves));
+        __m128i* hops = reinterpret_cast<__m128i*>(hop + lane);
+        _mm_storeu_si128(hops, _mm_blendv_epi8(_mm_loadu_si128(hops), from_lanes, take_hops));
+    }
+}
+#endif
+
+bool detectAVX2Lanes() {
+#ifdef BGP_HAVE_AVX2_KERNEL
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+const bool avx2_lanes = detectAVX2Lanes();
+
+}  // namespace
+
+const char* PrefixBlockEngine::getKernelName() {
+    return avx2_lanes ? "avx2" : "scalar";
+}
+
+PrefixBlockEngine::PrefixBlockEngine(const IndexedGraph& graph, const ROVValidator& validator,
+                                     size_t block_width)
+    : graph_(graph), validator_(validator), width_(block_width) {
+    if (!isSupportedWidth(block_width)) {
+        throw std::invalid_argument("block width must be 8, 16 or 32");
+    }
+    key_.resize(graph_.size() * width_);
+    next_hop_.resize(graph_.size() * width_);
+}
+
+template <size_t W>
+void PrefixBlockEngine::propagateBlock() {
+    const auto& ranks = graph_.getRanks();
+    using namespace RouteKey;
+    const uint64_t customer_field = prefField(Relationship::CUSTOMER);
+    const uint64_t peer_field = prefField(Relationship::PEER);
+    const uint64_t provider_field = prefField(Relationship::PROVIDER);
+    const uint64_t any_route = 1ULL << 48;  // Every route has a non-zero local pref
+
+    auto compare_mask = [this](uint32_t index) {
+        return compareMask(graph_.getDropInvalid(index));
+    };
+
+    // Offer neighbor 'from' routes to v's lanes with the kernel picked at startup
+    auto relax = [this](uint32_t v, const uint64_t* src, uint64_t pref_field, uint64_t min_export,
+                        uint32_t from, uint64_t mask, bool drop) {
+#ifdef BGP_HAVE_AVX2_KERNEL
+        if (avx2_lanes) {
+            relaxLanesAVX2<W>(&key_[v * W], &next_hop_[v * W], src, pref_field, min_export,
+                              from, mask, drop);
+            return;
+        }
+#endif
+        relaxLanes<W>(&key_[v * W], &next_hop_[v * W], src, pref_field, min_export,
+                      from, mask, drop);
+    };
+
+    // Phase 1: customer and origin routes climb the ranks
+    for (size_t r = 1; r < ranks.size(); r++) {
+        for (uint32_t v : ranks[r]) {
+            const uint64_t mask = compare_mask(v);
+            const bool drop = graph_.getDropInvalid(v);
+            for (uint32_t c : graph_.getCustomers(v)) {
+                relax(v, &key_[c * W], customer_field, customer_field, c, mask, drop);
+            }
+        }
+    }
+
+    // Peers see the routes as they stood at the end of phase 1
+    key_up_ = key_;
+    next_hop_up_ = next_hop_;
+
+    // Phase 2: one peer hop
+    for (uint32_t v = 0; v < graph_.size(); v++) {
+        const uint64_t mask = compare_mask(v);
+        const bool drop = graph_.getDropInvalid(v);
+        for (uint32_t u : graph_.getPeers(v)) {
+            relax(v, &key_up_[u * W], peer_field, customer_field, u, mask, drop);
+        }
+    }
+
+    // Phase 3: everything flows down to customers, top rank first
+    for (size_t r = ranks.size(); r-- > 0;) {
+        for (uint32_t v : ranks[r]) {
+            const uint64_t mask = compare_mask(v);
+            const bool drop = graph_.getDropInvalid(v);
+            for (uint32_t p : graph_.getProviders(v)) {
+                relax(v, &key_[p * W], provider_field, any_route, p, mask, drop);
+            }
+        }
+    }
+}
+
+size_t PrefixBlockEngine::runBlock(const PrefixTask* tasks, size_t count, ASGraph& graph,
+                                   std::mutex* install_mutex) {
+    count = std::min(count, width_);
+    std::fill(key_.begin(), key_.end(), 0);
+    std::fill(next_hop_.begin(), next_hop_.end(), IndexedGraph::kNoIndex);
+
+    // Seed one lane per prefix with its origins
+    size_t seeded = 0;
+    for (size_t lane = 0; lane < count; lane++) {
+        for (const auto& ann : tasks[lane].announcements) {
+            uint32_t origin = graph_.getIndex(ann.asn);
+            if (origin == IndexedGraph::kNoIndex) {
+                continue;
+            }
+            seeded++;
+            size_t slot = origin * width_ + lane;
+            if (key_[slot] != 0) {
+                continue;  // Duplicate announcement - first one wins, as in originatePrefix
+            }
+            ROVState state = validator_.validate(tasks[lane].prefix, ann.asn);
+            key_[slot] = RouteKey::origin(state, origin);
+            next_hop_[slot] = origin;
+        }
+    }
+
+    switch (width_) {
+        case 8: propagateBlock<8>(); break;
+        case 16: propagateBlock<16>(); break;
+        default: propagateBlock<32>(); break;
+    }
+
+    // Materialize the lanes as announcements, then install them in one go
+    std::vector<std::pair<AS*, Announcement>> routes;
+    std::vector<uint32_t> path;
+    for (uint32_t v = 0; v < graph_.size(); v++) {
+        AS* as_ptr = nullptr;
+        for (size_t lane = 0; lane < count; lane++) {
+            uint64_t key = key_[v * width_ + lane];
+            if (key == 0) {
+                continue;
+            }
+            if (!as_ptr) {
+                as_ptr = graph.getAS(graph_.getASN(v));
+            }
+
+            path.clear();
+            buildPath(v, lane, path);
+            Announcement ann(path.back(), tasks[lane].prefix);
+            ann.setASPath(path);
+            ann.setRelationship(RouteKey::getRelationship(key));
+            ann.setROVState(RouteKey::getROVState(key));
+            routes.emplace_back(as_ptr, std::move(ann));
+        }
+    }
+
+    std::unique_lock<std::mutex> lock;
+    if (install_mutex) {
+        lock = std::unique_lock<std::mutex>(*install_mutex);
+    }
+    for (const auto& [as_ptr, ann] : routes) {
+        as_ptr->installRoute(ann);
+    }
+
+    return seeded;
+}
+
+void PrefixBlockEngine::buildPath(uint32_t index, size_t lane, std::vector<uint32_t>& path) const {
+    RouteKey::buildPath(graph_, index,
+        [&](uint32_t v) { return std::make_pair(key_[v * width_ + lane], next_hop_[v * width_ + lane]); },
+        [&](uint32_t v) { return std::make_pair(key_up_[v * width_ + lane], next_hop_up_[v * width_ + lane]); },
+        path);
+}
@@ -0,0 +1,45 @@
+#include "PrefixClasses.h"
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+PrefixClasses PrefixClasses::group(const std::vector<InputAnnouncement>& announcements,
+                                   const ROVValidator& validator) {
+    // Collect each prefix's announcements in first-seen order
+    std::vector<std::string> order;
+    std::unordered_map<std::string, std::vector<const InputAnnouncement*>> by_prefix;
+    for (const auto& ann : announcements) {
+        auto& members = by_prefix[ann.prefix];
+        if (members.empty()) {
+            order.push_back(ann.prefix);
+        }
+        members.push_back(&ann);
+    }
+
+    // Class signature: (origin, ROV state) per announcement, in order.
+    // Keeping the order (and duplicates) makes classes safe for any tie-break.
+    using Signature = std::vector<std::pair<uint32_t, ROVState>>;
+    std::map<Signature, std::string> representative;
+
+    PrefixClasses classes;
+    classes.num_prefixes = order.size();
+    for (const auto& prefix : order) {
+        const auto& members = by_prefix[prefix];
+        Signature signature;
+        signature.reserve(members.size());
+        for (const InputAnnouncement* ann : members) {
+            signature.emplace_back(ann->asn, validator.validate(prefix, ann->asn));
+        }
+
+        auto [it, inserted] = representative.emplace(std::move(signature), prefix);
+        classes.aliases[it->second].push_back(prefix);
+        if (inserted) {
+            for (const InputAnnouncement* ann : members) {
+                classes.announcements.push_back(*ann);
+            }
+        }
+    }
+
+    return classes;
+}
@@ -0,0 +1,173 @@
+#include "PropagationRunner.h"
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+
+bool PropagationRunner::isKnownEngine(const std::string& engine) {
+    return engine == "inbox" || engine == "vector" || engine == "bfs";
+}
+
+PropagationRunner::PropagationRunner(ASGraph& graph, const std::string& engine,
+                                     const PropagationOptions& options, size_t num_threads,
+                                     size_t block_size)
+    : graph_(graph),
+      engine_(engine),
+      options_(options),
+      num_threads_(std::max<size_t>(num_threads, 1)),
+      block_size_(block_size),
+      max_rounds_(0),
+      executor_(num_threads_) {
+    if (!isKnownEngine(engine_)) {
+        throw std::invalid_argument("unknown engine: " + engine_);
+    }
+
+    if (engine_ == "vector") {
+        indexed_ = std::make_unique<IndexedGraph>(graph_);
+        for (size_t w = 0; w < num_threads_; w++) {
+            block_engines_.push_back(std::make_unique<PrefixBlockEngine>(
+                *indexed_, graph_.getROVValidator(), block_size_));
+        }
+    } else if (engine_ == "bfs") {
+        indexed_ = std::make_unique<IndexedGraph>(graph_);
+        for (size_t w = 0; w < num_threads_; w++) {
+            solvers_.push_back(std::make_unique<RouteSolver>(*indexed_, graph_.getROVValidator()));
+        }
+    } else if (num_threads_ > 1) {
+        for (size_t w = 0; w < num_threads_; w++) {
+            replicas_.push_back(graph_.cloneTopology());
+        }
+    }
+}
+
+std::string PropagationRunner::describe() const {
+    std::ostringstream oss;
+    if (engine_ == "vector") {
+        oss << "prefix-vectorized propagation (blocks of " << block_size_ << " prefixes, "
+            << PrefixBlockEngine::getKernelName() << " lanes)";
+    } else if (engine_ == "bfs") {
+        oss << "three-stage route solver";
+    } else {
+        oss << "hierarchical propagation";
+    }
+    if (num_threads_ > 1) {
+        oss << " on " << num_threads_ << " workers";
+    }
+    return oss.str();
+}
+
+size_t PropagationRunner::getBytesPerRoute() const {
+    // The single-graph inbox run also queues copies for every prefix of the
+    // batch at once
+    return engine_ == "inbox" && num_threads_ == 1 ? kInboxRouteBytes : kInstalledRouteBytes;
+}
+
+size_t PropagationRunner::getScratchBytesPerAS() const {
+    // Replicas queue copies for the prefix in flight; vector workers
+    // materialize a whole block of announcements before installing it
+    if (engine_ == "inbox" && num_threads_ > 1) {
+        return num_threads_ * kReplicaScratchBytes;
+    }
+    return engine_ == "vector" ? num_threads_ * block_size_ * kBlockScratchBytes : 0;
+}
+
+size_t PropagationRunner::run(const std::vector<InputAnnouncement>& announcements) {
+    if (engine_ == "inbox" && num_threads_ == 1) {
+        return runInbox(announcements);
+    }
+
+    auto tasks = PrefixCostModel::buildTasks(announcements);
+    if (engine_ == "vector") {
+        return runVector(tasks);
+    }
+
+    // Largest prefixes first only pays off with more than one worker
+    if (num_threads_ > 1) {
+        for (auto& task : tasks) {
+            task.cost = PrefixCostModel::estimate(graph_, task);
+        }
+    }
+    return engine_ == "bfs" ? runSolver(tasks) : runInboxReplicas(tasks);
+}
+
+size_t PropagationRunner::runVector(std::vector<PrefixTask>& tasks) {
+    // Many prefixes per walk: each block runs the three phases in lockstep
+    size_t num_blocks = (tasks.size() + block_size_ - 1) / block_size_;
+    std::atomic<size_t> seeded{0};
+    std::vector<double> costs(num_blocks, 1.0);
+
+    executor_.run(costs, [&](size_t worker, size_t block) {
+        size_t first = block * block_size_;
+        size_t count = std::min(block_size_, tasks.size() - first);
+        seeded += block_engines_[worker]->runBlock(&tasks[first], count, graph_, &install_mutex_);
+    });
+
+    return seeded;
+}
+
+size_t PropagationRunner::runSolver(std::vector<PrefixTask>& tasks) {
+    // One prefix at a time: three searches that only visit reached ASes
+    std::atomic<size_t> seeded{0};
+
+    executor_.run(tasks, [&](size_t worker, PrefixTask& task) {
+        seeded += solvers_[worker]->solve(task, graph_, &install_mutex_);
+    });
+
+    return seeded;
+}
+
+size_t PropagationRunner::runInbox(const std::vector<InputAnnouncement>& announcements) {
+    size_t seeded = 0;
+    for (const auto& input_ann : announcements) {
+        AS* origin_as = graph_.getAS(input_ann.asn);
+        if (!origin_as) {
+            continue;
+        }
+
+        // Originate all announcements (including invalid ones)
+        // ROV-enabled ASes will drop invalid routes during propagation
+        origin_as->originatePrefix(input_ann.prefix);
+        seeded++;
+    }
+
+    // Run BGPy-style hierarchical propagation until convergence
+    max_rounds_ = std::max(max_rounds_, graph_.propagateToConvergence(options_));
+    return seeded;
+}
+
+size_t PropagationRunner::runInboxReplicas(std::vector<PrefixTask>& tasks) {
+    // Prefixes propagate independently: simulate each one on a worker's
+    // private topology replica and install the results into the graph
+    size_t seeded = 0;
+
+    executor_.run(tasks, [&](size_t worker, PrefixTask& task) {
+        ASGraph& replica = *replicas_[worker];
+        size_t task_seeded = 0;
+
+        for (const auto& input_ann : task.announcements) {
+            AS* origin_as = replica.getAS(input_ann.asn);
+            if (!origin_as) {
+                continue;
+            }
+            origin_as->originatePrefix(input_ann.prefix);
+            task_seeded++;
+        }
+
+        int rounds = replica.propagateToConvergence(options_);
+
+        std::lock_guard<std::mutex> lock(install_mutex_);
+        for (const auto& [asn, as_ptr] : replica.getAllASes()) {
+            for (const auto& [prefix, ann] : as_ptr->getRoutingTable()) {
+                graph_.getAS(asn)->installRoute(ann);
+            }
+            if (as_ptr->hasAlternates()) {
+                graph_.getAS(asn)->adoptAlternates(*as_ptr);
+            }
+        }
+        seeded += task_seeded;
+        max_rounds_ = std::max(max_rounds_, rounds);
+        replica.clearRoutingTables();
+    });
+
+    return seeded;
+}
@@ -0,0 +1,78 @@
+#include "ROVPlacement.h"
+#include <fstream>
+#include <iostream>
+#include <queue>
+
+ROVPlacement::ROVPlacement(IncrementalSimulation& simulation, size_t num_threads)
+    : simulation_(simulation), executor_(num_threads) {}
+
+std::vector<int64_t> ROVPlacement::evaluate(const std::vector<uint32_t>& asns) {
+    std::vector<int64_t> gains(asns.size(), 0);
+    std::vector<double> costs(asns.size(), 1.0);
+    executor_.run(costs, [&](size_t, size_t i) {
+        auto change = IncrementalSimulation::Change::setROV(asns[i], true);
+        gains[i] = -simulation_.getInvalidRouteDelta(change);
+    });
+    evaluations_ += asns.size();
+    return gains;
+}
+
+std::vector<ROVPlacement::Pick> ROVPlacement::run(const std::vector<uint32_t>& candidates,
+                                                  size_t k) {
+    // Gain as of the given round (number of picks made when it was evaluated)
+    struct Entry {
+        int64_t gain;
+        uint32_t asn;
+        size_t round;
+    };
+    auto lower = [](const Entry& a, const Entry& b) {
+        return a.gain != b.gain ? a.gain < b.gain : a.asn > b.asn;  // Ties: lowest ASN first
+    };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(lower)> heap(lower);
+
+    std::vector<int64_t> gains = evaluate(candidates);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        heap.push(Entry{gains[i], candidates[i], 0});
+    }
+
+    std::vector<Pick> picks;
+    while (picks.size() < k && !heap.empty()) {
+        if (heap.top().round == picks.size()) {
+            Entry best = heap.top();
+            heap.pop();
+            if (best.gain <= 0) {
+                break;
+            }
+            simulation_.apply(IncrementalSimulation::Change::setROV(best.asn, true));
+            picks.push_back(Pick{best.asn, best.gain, simulation_.countInvalidRoutes(), evaluations_});
+            continue;
+        }
+
+        // Refresh the stale entries at the top, one per worker
+        std::vector<uint32_t> stale;
+        while (!heap.empty() && heap.top().round != picks.size() &&
+               stale.size() < executor_.getWorkerCount()) {
+            stale.push_back(heap.top().asn);
+            heap.pop();
+        }
+        gains = evaluate(stale);
+        for (size_t i = 0; i < stale.size(); i++) {
+            heap.push(Entry{gains[i], stale[i], picks.size()});
+        }
+    }
+    return picks;
+}
+
+bool ROVPlacement::writeCSV(const std::string& filename, const std::vector<Pick>& picks) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    file << "rank,asn,protected_routes,invalid_routes_after,evaluations\n";
+    for (size_t i = 0; i < picks.size(); i++) {
+        file << i + 1 << "," << picks[i].asn << "," << picks[i].gain << ","
+             << picks[i].invalid_after << "," << picks[i].evaluations << "\n";
+    }
+    return true;
+}
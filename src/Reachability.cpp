@@ -0,0 +1,101 @@
+#include "Reachability.h"
+#include <algorithm>
+
+ReachabilityEngine::ReachabilityEngine(const IndexedGraph& graph)
+    : graph_(graph),
+      customer_(graph.size(), 0),
+      peer_(graph.size(), 0),
+      provider_(graph.size(), 0) {}
+
+void ReachabilityEngine::runPass(const uint32_t* origins, size_t count) {
+    count = std::min(count, kOriginsPerPass);
+    origins_.assign(origins, origins + count);
+    std::fill(customer_.begin(), customer_.end(), 0);
+    std::fill(peer_.begin(), peer_.end(), 0);
+    std::fill(provider_.begin(), provider_.end(), 0);
+
+    for (size_t i = 0; i < count; i++) {
+        customer_[origins_[i]] |= 1ULL << i;
+    }
+
+    const auto& ranks = graph_.getRanks();
+
+    // Up: customer routes climb the ranks
+    for (size_t r = 1; r < ranks.size(); r++) {
+        for (uint32_t v : ranks[r]) {
+            uint64_t mask = customer_[v];
+            for (uint32_t c : graph_.getCustomers(v)) {
+                mask |= customer_[c];
+            }
+            customer_[v] = mask;
+        }
+    }
+
+    // Peer: one hop, customer routes only
+    for (uint32_t v = 0; v < graph_.size(); v++) {
+        uint64_t mask = 0;
+        for (uint32_t u : graph_.getPeers(v)) {
+            mask |= customer_[u];
+        }
+        peer_[v] = mask & ~customer_[v];
+    }
+
+    // Down: every route flows to customers, top rank first
+    for (size_t r = ranks.size(); r-- > 0;) {
+        for (uint32_t v : ranks[r]) {
+            uint64_t mask = 0;
+            for (uint32_t p : graph_.getProviders(v)) {
+                mask |= customer_[p] | peer_[p] | provider_[p];
+            }
+            provider_[v] = mask & ~(customer_[v] | peer_[v]);
+        }
+    }
+}
+
+void ReachabilityEngine::writeSummaryRows(std::ostream& out) const {
+    std::vector<size_t> customer(origins_.size(), 0);
+    std::vector<size_t> peer(origins_.size(), 0);
+    std::vector<size_t> provider(origins_.size(), 0);
+
+    auto count_bits = [](std::vector<size_t>& counts, uint64_t mask) {
+        while (mask) {
+            counts[__builtin_ctzll(mask)]++;
+            mask &= mask - 1;
+        }
+    };
+
+    for (uint32_t v = 0; v < graph_.size(); v++) {
+        count_bits(customer, customer_[v]);
+        count_bits(peer, peer_[v]);
+        count_bits(provider, provider_[v]);
+    }
+
+    for (size_t i = 0; i < origins_.size(); i++) {
+        // The origin's own bit sits in the customer mask
+        size_t reached = customer[i] + peer[i] + provider[i];
+        out << graph_.getASN(origins_[i]) << ","
+            << customer[i] - 1 << ","
+            << peer[i] << ","
+            << provider[i] << ","
+            << graph_.size() - reached << "\n";
+    }
+}
+
+void ReachabilityEngine::writeMatrixRows(std::ostream& out) const {
+    for (uint32_t v = 0; v < graph_.size(); v++) {
+        for (size_t i = 0; i < origins_.size(); i++) {
+            uint64_t bit = 1ULL << i;
+            const char* rel = nullptr;
+            if (customer_[v] & bit) {
+                rel = origins_[i] == v ? "origin" : "customer";
+            } else if (peer_[v] & bit) {
+                rel = "peer";
+            } else if (provider_[v] & bit) {
+                rel = "provider";
+            }
+            if (rel) {
+                out << graph_.getASN(v) << "," << graph_.getASN(origins_[i]) << "," << rel << "\n";
+            }
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#include "RouteLeaks.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+RouteLeaks::RouteLeaks(const IncrementalSimulation& simulation, size_t num_threads)
+    : simulation_(simulation), executor_(num_threads) {}
+
+std::vector<RouteLeaks::Result> RouteLeaks::run(const std::string& prefix,
+                                                const std::vector<uint32_t>& leakers) {
+    std::vector<Result> results(leakers.size());
+    std::vector<double> costs(leakers.size(), 1.0);
+    executor_.run(costs, [&](size_t, size_t i) {
+        results[i] = Result{leakers[i], simulation_.countLeakAdopters(leakers[i], prefix)};
+    });
+    std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) {
+        return a.adopters != b.adopters ? a.adopters > b.adopters : a.leaker < b.leaker;
+    });
+    return results;
+}
+
+bool RouteLeaks::writeCSV(const std::string& filename, const std::string& prefix,
+                          const std::vector<Result>& results, size_t as_count) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    size_t others = as_count > 1 ? as_count - 1 : 1;
+    file << "prefix,leaker,adopting_ases,adoption_share\n";
+    for (const auto& result : results) {
+        file << prefix << "," << result.leaker << "," << result.adopters << ","
+             << static_cast<double>(result.adopters) / others << "\n";
+    }
+    return true;
+}
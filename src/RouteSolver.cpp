@@ -0,0 +1,175 @@
+#include "RouteSolver.h"
+#include "RouteKey.h"
+#include <utility>
+
+RouteSolver::RouteSolver(const IndexedGraph& graph, const ROVValidator& validator)
+    : RouteSolver(graph, validator, graph.getDropInvalidFlags()) {}
+
+RouteSolver::RouteSolver(const IndexedGraph& graph, const ROVValidator& validator,
+                         const std::vector<uint8_t>& drop_invalid)
+    : graph_(graph), validator_(validator), drop_invalid_(drop_invalid.data()) {
+    key_.assign(graph_.size(), 0);
+    hop_.assign(graph_.size(), IndexedGraph::kNoIndex);
+    up_key_.assign(graph_.size(), 0);
+    up_hop_.assign(graph_.size(), IndexedGraph::kNoIndex);
+    queued_.assign(graph_.size(), 0);
+    buckets_.resize(graph_.getRanks().size());
+}
+
+bool RouteSolver::relax(uint32_t to, uint64_t candidate, uint32_t from) {
+    bool drop = drop_invalid_[to] != 0;
+    if (drop && (candidate & RouteKey::kRankMask) == 0) {
+        return false;  // ROV drops INVALID routes
+    }
+
+    uint64_t mask = RouteKey::compareMask(drop);
+    if (key_[to] != 0 && (RouteKey::isOrigin(key_[to]) || (candidate & mask) <= (key_[to] & mask))) {
+        return false;
+    }
+
+    if (key_[to] == 0) {
+        touched_.push_back(to);
+    }
+    key_[to] = candidate;
+    hop_[to] = from;
+    return true;
+}
+
+void RouteSolver::enqueue(uint32_t index) {
+    if (!queued_[index]) {
+        queued_[index] = 1;
+        buckets_[graph_.getRank(index)].push_back(index);
+    }
+}
+
+void RouteSolver::upStage() {
+    const uint64_t customer_field = RouteKey::prefField(Relationship::CUSTOMER);
+
+    // Providers always rank above their customers, so by the time a bucket
+    // is drained every AS in it holds its final customer route
+    for (size_t r = 0; r < buckets_.size(); r++) {
+        for (size_t i = 0; i < buckets_[r].size(); i++) {
+            uint32_t v = buckets_[r][i];
+            queued_[v] = 0;
+            uint64_t route = RouteKey::extend(key_[v], customer_field, v);
+            for (uint32_t p : graph_.getProviders(v)) {
+                if (relax(p, route, v)) {
+                    enqueue(p);
+                }
+            }
+        }
+        buckets_[r].clear();
+    }
+}
+
+void RouteSolver::peerStage(size_t up_count) {
+    const uint64_t peer_field = RouteKey::prefField(Relationship::PEER);
+
+    // Only the ASes reached going up hold customer/origin routes
+    for (size_t i = 0; i < up_count; i++) {
+        uint32_t v = touched_[i];
+        uint64_t route = RouteKey::extend(up_key_[v], peer_field, v);
+        for (uint32_t u : graph_.getPeers(v)) {
+            relax(u, route, v);
+        }
+    }
+}
+
+void RouteSolver::downStage() {
+    const uint64_t provider_field = RouteKey::prefField(Relationship::PROVIDER);
+
+    for (size_t i = 0; i < touched_.size(); i++) {
+        enqueue(touched_[i]);
+    }
+
+    for (size_t r = buckets_.size(); r-- > 0;) {
+        for (size_t i = 0; i < buckets_[r].size(); i++) {
+            uint32_t v = buckets_[r][i];
+            queued_[v] = 0;
+            uint64_t route = RouteKey::extend(key_[v], provider_field, v);
+            for (uint32_t c : graph_.getCustomers(v)) {
+                if (relax(c, route, v)) {
+                    enqueue(c);
+                }
+            }
+        }
+        buckets_[r].clear();
+    }
+}
+
+void RouteSolver::reset() {
+    for (uint32_t v : touched_) {
+        key_[v] = 0;
+        hop_[v] = IndexedGraph::kNoIndex;
+        up_key_[v] = 0;
+        up_hop_[v] = IndexedGraph::kNoIndex;
+    }
+    touched_.clear();
+}
+
+size_t RouteSolver::solve(const PrefixTask& task, ASGraph& graph, std::mutex* install_mutex) {
+    size_t seeded = compute(task);
+
+    // Materialize the routes, then install them in one go
+    std::vector<std::pair<AS*, Announcement>> routes;
+    routes.reserve(touched_.size());
+    std::vector<uint32_t> path;
+    for (uint32_t v : touched_) {
+        path.clear();
+        buildPath(v, path);
+        Announcement ann(path.back(), task.prefix);
+        ann.setASPath(path);
+        ann.setRelationship(RouteKey::getRelationship(key_[v]));
+        ann.setROVState(RouteKey::getROVState(key_[v]));
+        routes.emplace_back(graph.getAS(graph_.getASN(v)), std::move(ann));
+    }
+
+    std::unique_lock<std::mutex> lock;
+    if (install_mutex) {
+        lock = std::unique_lock<std::mutex>(*install_mutex);
+    }
+    for (const auto& [as_ptr, ann] : routes) {
+        as_ptr->installRoute(ann);
+    }
+
+    return seeded;
+}
+
+size_t RouteSolver::compute(const PrefixTask& task) {
+    reset();
+
+    size_t seeded = 0;
+    for (const auto& ann : task.announcements) {
+        uint32_t origin = graph_.getIndex(ann.asn);
+        if (origin == IndexedGraph::kNoIndex) {
+            continue;
+        }
+        seeded++;
+        if (key_[origin] != 0) {
+            continue;  // Duplicate announcement - first one wins, as in originatePrefix
+        }
+        touched_.push_back(origin);
+        key_[origin] = RouteKey::origin(validator_.validate(task.prefix, ann.asn), origin);
+        hop_[origin] = origin;
+        enqueue(origin);
+    }
+
+    upStage();
+
+    size_t up_count = touched_.size();
+    for (size_t i = 0; i < up_count; i++) {
+        uint32_t v = touched_[i];
+        up_key_[v] = key_[v];
+        up_hop_[v] = hop_[v];
+    }
+
+    peerStage(up_count);
+    downStage();
+    return seeded;
+}
+
+void RouteSolver::buildPath(uint32_t index, std::vector<uint32_t>& path) const {
+    RouteKey::buildPath(graph_, index,
+        [this](uint32_t v) { return std::make_pair(key_[v], hop_[v]); },
+        [this](uint32_t v) { return std::make_pair(up_key_[v], up_hop_[v]); }, path);
+}
@@ -0,0 +1,90 @@
+#include "RouteSummary.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+void RouteSummary::addTable(const std::unordered_map<std::string, Announcement>& table, bool rov) {
+    for (const auto& [prefix, ann] : table) {
+        // A prefix has a handful of origins; a linear scan beats a map
+        auto& origins = counts_[prefix];
+        auto it = std::find_if(origins.begin(), origins.end(),
+                               [&ann](const Counts& c) { return c.origin == ann.getOrigin(); });
+        if (it == origins.end()) {
+            origins.push_back(Counts{ann.getOrigin()});
+            it = origins.end() - 1;
+        }
+        it->ases[rov][static_cast<size_t>(ann.getRelationship())]++;
+    }
+}
+
+void RouteSummary::add(const ASGraph& graph, const std::vector<uint32_t>& asns) {
+    for (const auto& [asn, as] : graph.getAllASes()) {
+        if (!asns.empty() && std::find(asns.begin(), asns.end(), asn) == asns.end()) {
+            continue;
+        }
+        if (graph.isDerived(asn)) {
+            addTable(graph.getRoutingTable(asn), as->getDropInvalid());
+        } else {
+            addTable(as->getRoutingTable(), as->getDropInvalid());
+        }
+    }
+}
+
+bool RouteSummary::writeCSV(const std::string& filename, const PrefixAliases& aliases) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    file << "prefix,origin,ases,origin_ases,rov_ases,non_rov_ases,"
+         << "rov_customer,rov_peer,rov_provider,non_rov_customer,non_rov_peer,non_rov_provider\n";
+
+    // Announced prefix -> its simulated prefix's counts
+    std::vector<std::pair<std::string, const std::vector<Counts>*>> rows;
+    for (const auto& [prefix, origins] : counts_) {
+        auto alias = aliases.find(prefix);
+        if (alias == aliases.end()) {
+            rows.emplace_back(prefix, &origins);
+        } else {
+            for (const auto& member : alias->second) {
+                rows.emplace_back(member, &origins);
+            }
+        }
+    }
+    std::sort(rows.begin(), rows.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    const size_t origin = static_cast<size_t>(Relationship::ORIGIN);
+    const size_t customer = static_cast<size_t>(Relationship::CUSTOMER);
+    const size_t peer = static_cast<size_t>(Relationship::PEER);
+    const size_t provider = static_cast<size_t>(Relationship::PROVIDER);
+    for (const auto& [prefix, origins] : rows) {
+        std::vector<const Counts*> sorted;
+        for (const auto& counts : *origins) {
+            sorted.push_back(&counts);
+        }
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const Counts* a, const Counts* b) { return a->origin < b->origin; });
+
+        for (const Counts* counts : sorted) {
+            // The origin's own route is counted once, apart from the learned
+            // routes, so ases = origin_ases + rov_ases + non_rov_ases
+            size_t originated = counts->ases[0][origin] + counts->ases[1][origin];
+            size_t learned[2] = {0, 0};
+            for (int rov = 0; rov < 2; rov++) {
+                learned[rov] = counts->ases[rov][customer] + counts->ases[rov][peer] +
+                               counts->ases[rov][provider];
+            }
+            file << prefix << "," << counts->origin << ","
+                 << originated + learned[0] + learned[1] << "," << originated << ","
+                 << learned[1] << "," << learned[0];
+            for (int rov : {1, 0}) {
+                file << "," << counts->ases[rov][customer] << "," << counts->ases[rov][peer] << ","
+                     << counts->ases[rov][provider];
+            }
+            file << "\n";
+        }
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+#include "ScenarioRunner.h"
+#include "CSVInput.h"
+#include "CSVOutput.h"
+#include "PrefixClasses.h"
+#include "RouteSolver.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+std::vector<ScenarioRunner::Scenario> ScenarioRunner::parseManifest(const std::string& filename) {
+    std::vector<Scenario> scenarios;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open scenario manifest: " << filename << std::endl;
+        return scenarios;
+    }
+
+    fs::path base = fs::path(filename).parent_path();
+    auto resolve = [&base](const std::string& path) {
+        return path.empty() || fs::path(path).is_absolute() ? path : (base / path).string();
+    };
+
+    std::string line;
+    for (int line_num = 1; std::getline(file, line); line_num++) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::istringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 2 || fields.size() > 3 || fields[0].empty() || fields[1].empty()) {
+            std::cerr << "Warning: Could not parse scenario line " << line_num << ": " << line
+                      << std::endl;
+            continue;
+        }
+        scenarios.push_back(Scenario{fields[0], resolve(fields[1]),
+                                     fields.size() > 2 ? resolve(fields[2]) : "", ""});
+    }
+    return scenarios;
+}
+
+bool ScenarioRunner::validate(const std::vector<Scenario>& scenarios) {
+    bool ok = true;
+    std::unordered_set<std::string> names;
+    std::unordered_map<std::string, std::string> outputs;
+    for (const auto& scenario : scenarios) {
+        // An unreadable ROV file would otherwise run as no ROV at all
+        for (const std::string* input : {&scenario.announcements_file, &scenario.rov_asns_file}) {
+            if (!input->empty() && !std::ifstream(*input).is_open()) {
+                std::cerr << "Error: Scenario " << scenario.name << ": could not open " << *input
+                          << std::endl;
+                ok = false;
+            }
+        }
+        // Two workers must never write the same file
+        auto output = outputs.emplace(scenario.output_file, scenario.name);
+        if (!names.insert(scenario.name).second) {
+            std::cerr << "Error: Duplicate scenario name " << scenario.name << std::endl;
+            ok = false;
+        } else if (!output.second) {
+            std::cerr << "Error: Scenarios " << output.first->second << " and " << scenario.name
+                      << " would both write " << scenario.output_file << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+ScenarioRunner::ScenarioRunner(const ASGraph& graph, size_t num_threads)
+    : topology_(graph), executor_(num_threads) {
+    for (size_t w = 0; w < executor_.getWorkerCount(); w++) {
+        ribs_.push_back(graph.cloneTopology());
+    }
+}
+
+bool ScenarioRunner::run(const std::vector<Scenario>& scenarios) {
+    results_.assign(scenarios.size(), Result());
+    std::vector<double> costs(scenarios.size(), 1.0);
+    executor_.run(costs, [&](size_t worker, size_t index) {
+        results_[index] = runScenario(scenarios[index], *ribs_[worker]);
+    });
+
+    for (const auto& result : results_) {
+        if (!result.ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ScenarioRunner::Result ScenarioRunner::runScenario(const Scenario& scenario, ASGraph& ribs) const {
+    auto start = std::chrono::steady_clock::now();
+    Result result;
+
+    auto announcements = CSVInput::parseAnnouncements(scenario.announcements_file);
+    if (announcements.empty()) {
+        std::cerr << "Error: Scenario " << scenario.name << " has no announcements" << std::endl;
+        return result;
+    }
+
+    // The scenario's ROAs and ROV policy; the topology stays shared
+    ROVValidator validator;
+    for (const auto& ann : announcements) {
+        if (!ann.rov_invalid) {
+            validator.addROA(ann.prefix, ann.asn);
+        }
+    }
+    std::vector<uint8_t> drop_invalid(topology_.size(), 0);
+    if (!scenario.rov_asns_file.empty()) {
+        for (uint32_t asn : CSVInput::parseROVASNs(scenario.rov_asns_file)) {
+            uint32_t index = topology_.getIndex(asn);
+            if (index != IndexedGraph::kNoIndex) {
+                drop_invalid[index] = 1;
+            }
+        }
+    }
+
+    PrefixClasses classes = PrefixClasses::group(announcements, validator);
+    RouteSolver solver(topology_, validator, drop_invalid);
+    for (const auto& task : PrefixCostModel::buildTasks(classes.announcements)) {
+        result.seeded += solver.solve(task, ribs);
+    }
+
+    result.ok = CSVOutput::writeRoutingTable(ribs, scenario.output_file, classes.aliases);
+    ribs.clearRoutingTables();
+    result.prefixes = classes.num_prefixes;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
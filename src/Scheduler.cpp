@@ -0,0 +1,183 @@
+#include "Scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+std::vector<PrefixTask> PrefixCostModel::buildTasks(const std::vector<InputAnnouncement>& announcements) {
+    std::vector<PrefixTask> tasks;
+    std::unordered_map<std::string, size_t> index;
+
+    for (const auto& ann : announcements) {
+        auto it = index.find(ann.prefix);
+        if (it == index.end()) {
+            index[ann.prefix] = tasks.size();
+            tasks.push_back(PrefixTask{ann.prefix, {ann}, 0.0});
+        } else {
+            tasks[it->second].announcements.push_back(ann);
+        }
+    }
+
+    return tasks;
+}
+
+double PrefixCostModel::estimate(const ASGraph& graph, const PrefixTask& task) {
+    // Every origin pays a fixed sweep over the graph plus work proportional to
+    // the cone its route climbs out of. Competing origins keep routes
+    // changing for longer, so the sum is scaled by the number of origins.
+    const double sweep_cost = static_cast<double>(graph.size()) / 64.0 + 1.0;
+    std::unordered_set<uint32_t> origins;
+    double cone_cost = 0.0;
+
+    for (const auto& ann : task.announcements) {
+        if (origins.insert(ann.asn).second) {
+            cone_cost += sweep_cost + static_cast<double>(graph.getCustomerConeSize(ann.asn));
+        }
+    }
+
+    return cone_cost * static_cast<double>(std::max<size_t>(origins.size(), 1));
+}
+
+WorkStealingExecutor::WorkStealingExecutor(size_t num_workers)
+    : num_workers_(std::max<size_t>(num_workers, 1)), stats_(num_workers_), wall_seconds_(0.0) {}
+
+void WorkStealingExecutor::resetStats() {
+    stats_.assign(num_workers_, WorkerStats());
+    wall_seconds_ = 0.0;
+}
+
+void WorkStealingExecutor::run(std::vector<PrefixTask>& tasks,
+                               const std::function<void(size_t, PrefixTask&)>& fn) {
+    std::vector<double> costs;
+    costs.reserve(tasks.size());
+    for (const auto& task : tasks) {
+        costs.push_back(task.cost);
+    }
+
+    run(costs, [&](size_t worker, size_t index) { fn(worker, tasks[index]); });
+}
+
+void WorkStealingExecutor::run(const std::vector<double>& costs,
+                               const std::function<void(size_t, size_t)>& fn) {
+    using Clock = std::chrono::steady_clock;
+
+    // Largest first, then deal round-robin so every deque starts with
+    // a similar mix of expensive and cheap tasks
+    std::vector<size_t> order(costs.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&costs](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+    struct WorkerDeque {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+    std::vector<WorkerDeque> deques(num_workers_);
+    for (size_t i = 0; i < order.size(); i++) {
+        deques[i % num_workers_].tasks.push_back(order[i]);
+    }
+
+    std::vector<WorkerStats> run_stats(num_workers_);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto worker_loop = [&](size_t self) {
+        WorkerStats& stats = run_stats[self];
+
+        while (true) {
+            size_t task = 0;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> lock(deques[self].mutex);
+                if (!deques[self].tasks.empty()) {
+                    task = deques[self].tasks.front();
+                    deques[self].tasks.pop_front();
+                    found = true;
+                }
+            }
+
+            // Own deque empty - steal the cheapest task from another worker
+            for (size_t offset = 1; !found && offset < num_workers_; offset++) {
+                WorkerDeque& victim = deques[(self + offset) % num_workers_];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                    task = victim.tasks.back();
+                    victim.tasks.pop_back();
+                    found = true;
+                    stats.steals++;
+                }
+            }
+
+            // Tasks never spawn new work, so empty deques mean we are done
+            if (!found) {
+                break;
+            }
+
+            auto task_start = Clock::now();
+            try {
+                fn(self, task);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            stats.busy_seconds += std::chrono::duration<double>(Clock::now() - task_start).count();
+            stats.tasks++;
+        }
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers_ - 1);
+    for (size_t w = 1; w < num_workers_; w++) {
+        threads.emplace_back(worker_loop, w);
+    }
+    worker_loop(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    wall_seconds_ += wall_seconds;
+
+    // Idle time covers stealing attempts and waiting for the slowest worker
+    for (size_t w = 0; w < num_workers_; w++) {
+        stats_[w].tasks += run_stats[w].tasks;
+        stats_[w].steals += run_stats[w].steals;
+        stats_[w].busy_seconds += run_stats[w].busy_seconds;
+        stats_[w].idle_seconds += std::max(0.0, wall_seconds - run_stats[w].busy_seconds);
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::string WorkStealingExecutor::getSummary() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    oss << "  Worker   Tasks  Steals    Busy(s)    Idle(s)   Util\n";
+
+    for (size_t w = 0; w < stats_.size(); w++) {
+        const WorkerStats& stats = stats_[w];
+        double util = wall_seconds_ > 0.0 ? 100.0 * stats.busy_seconds / wall_seconds_ : 0.0;
+        oss << "  " << std::setw(6) << w
+            << "  " << std::setw(6) << stats.tasks
+            << "  " << std::setw(6) << stats.steals
+            << "  " << std::setw(9) << stats.busy_seconds
+            << "  " << std::setw(9) << stats.idle_seconds
+            << "  " << std::setw(5) << std::setprecision(1) << util << "%\n"
+            << std::setprecision(3);
+    }
+    oss << "  Wall time: " << wall_seconds_ << "s\n";
+
+    return oss.str();
+}
@@ -0,0 +1,278 @@
+#include "ShardDirectory.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+ShardDirectory::ShardDirectory(const std::string& dir)
+    : dir_(dir), num_shards_(0) {}
+
+std::string ShardDirectory::path(const std::string& name) const {
+    return (fs::path(dir_) / name).string();
+}
+
+bool ShardDirectory::create(const std::string& relationships_file,
+                            const std::string& announcements_file,
+                            const std::string& rov_asns_file,
+                            const std::string& vantage_file,
+                            TieBreak tie_break,
+                            const std::vector<InputAnnouncement>& announcements,
+                            size_t num_shards) {
+    std::error_code ec;
+    if (fs::exists(path("manifest.txt"), ec)) {
+        std::cerr << "Error: Shard directory " << dir_ << " is already in use" << std::endl;
+        return false;
+    }
+    for (const char* sub : {"pending", "claimed", "ribs"}) {
+        fs::create_directories(path(sub), ec);
+        if (ec) {
+            std::cerr << "Error: Could not create " << path(sub) << ": " << ec.message() << std::endl;
+            return false;
+        }
+    }
+
+    // Snapshot the inputs so workers never read files the coordinator's
+    // caller might change mid-run
+    relationships_file_ = "relationships.txt";
+    announcements_file_ = "announcements.csv";
+    rov_asns_file_ = rov_asns_file.empty() ? "" : "rov_asns.csv";
+    vantage_file_ = vantage_file.empty() ? "" : "vantage_asns.txt";
+    tie_break_ = tie_break;
+    auto snapshot = [&](const std::string& from, const std::string& to) {
+        fs::copy_file(from, path(to), fs::copy_options::overwrite_existing, ec);
+        if (ec) {
+            std::cerr << "Error: Could not copy " << from << ": " << ec.message() << std::endl;
+            return false;
+        }
+        return true;
+    };
+    if (!snapshot(relationships_file, relationships_file_) ||
+        !snapshot(announcements_file, announcements_file_) ||
+        (!rov_asns_file_.empty() && !snapshot(rov_asns_file, rov_asns_file_)) ||
+        (!vantage_file_.empty() && !snapshot(vantage_file, vantage_file_))) {
+        return false;
+    }
+
+    // Deal prefixes round-robin in first-seen order
+    num_shards_ = std::max<size_t>(num_shards, 1);
+    std::unordered_map<std::string, size_t> shard_of;
+    std::vector<std::ostringstream> rows(num_shards_);
+    for (const auto& ann : announcements) {
+        auto [it, inserted] = shard_of.emplace(ann.prefix, shard_of.size() % num_shards_);
+        rows[it->second] << ann.asn << "," << ann.prefix << ","
+                         << (ann.rov_invalid ? "True" : "False") << "\n";
+    }
+    num_shards_ = std::min(num_shards_, std::max<size_t>(shard_of.size(), 1));
+
+    for (size_t s = 0; s < num_shards_; s++) {
+        std::ostringstream name;
+        name << "shard-" << std::setw(5) << std::setfill('0') << s << ".csv";
+        std::ofstream file(path("pending/" + name.str()));
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not write shard " << name.str() << std::endl;
+            return false;
+        }
+        file << "seed_asn,prefix,rov_invalid\n" << rows[s].str();
+    }
+
+    // The manifest appears last: workers treat it as "ready"
+    std::string manifest = path("manifest.txt");
+    {
+        std::ofstream file(manifest + ".tmp");
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not write " << manifest << std::endl;
+            return false;
+        }
+        file << "shards=" << num_shards_ << "\n";
+        file << "relationships=" << relationships_file_ << "\n";
+        file << "announcements=" << announcements_file_ << "\n";
+        file << "rov_asns=" << rov_asns_file_ << "\n";
+        file << "vantage_asns=" << vantage_file_ << "\n";
+        file << "tie_break=" << (tie_break_ == TieBreak::OLDEST_PATH ? "oldest" : "lowest-asn") << "\n";
+    }
+    if (std::rename((manifest + ".tmp").c_str(), manifest.c_str()) != 0) {
+        std::cerr << "Error: Could not publish " << manifest << std::endl;
+        return false;
+    }
+    return load();
+}
+
+bool ShardDirectory::load() {
+    std::ifstream file(path("manifest.txt"));
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        if (key == "shards") {
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), num_shards_);
+            if (value.empty() || error != std::errc() || end != value.data() + value.size()) {
+                std::cerr << "Error: " << path("manifest.txt") << " has an invalid shard count '" << value
+                          << "'" << std::endl;
+                return false;
+            }
+        } else if (key == "relationships") {
+            relationships_file_ = path(value);
+        } else if (key == "announcements") {
+            announcements_file_ = path(value);
+        } else if (key == "rov_asns") {
+            rov_asns_file_ = value.empty() ? "" : path(value);
+        } else if (key == "vantage_asns") {
+            vantage_file_ = value.empty() ? "" : path(value);
+        } else if (key == "tie_break") {
+            tie_break_ = value == "oldest" ? TieBreak::OLDEST_PATH : TieBreak::LOWEST_NEIGHBOR_ASN;
+        }
+    }
+    if (num_shards_ == 0 || relationships_file_.empty()) {
+        std::cerr << "Error: " << path("manifest.txt") << " needs a shard count and a relationships file"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ShardDirectory::hasManifest() const {
+    std::error_code ec;
+    return fs::exists(path("manifest.txt"), ec);
+}
+
+std::string ShardDirectory::claim(const std::string& worker_id) {
+    std::vector<std::string> pending;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(path("pending"), ec)) {
+        pending.push_back(entry.path().filename().string());
+    }
+    std::sort(pending.begin(), pending.end());
+
+    // Losing a rename race just means another worker got that shard first.
+    // rename() keeps the file's mtime, so the lease starts with a renewal.
+    for (const auto& name : pending) {
+        std::string claimed = path("claimed/" + name + "." + worker_id);
+        if (std::rename(path("pending/" + name).c_str(), claimed.c_str()) == 0) {
+            renew(claimed);
+            return claimed;
+        }
+    }
+    return "";
+}
+
+bool ShardDirectory::release(const std::string& claimed) {
+    std::remove(getPartialFile(claimed).c_str());
+    std::string pending = path("pending/" + getShardName(claimed));
+    return std::rename(claimed.c_str(), pending.c_str()) == 0;
+}
+
+bool ShardDirectory::renew(const std::string& claimed) {
+    std::error_code ec;
+    fs::last_write_time(claimed, fs::file_time_type::clock::now(), ec);
+    return !ec;
+}
+
+size_t ShardDirectory::reclaimExpired(double lease_seconds) {
+    std::vector<std::string> expired;
+    std::error_code ec;
+    auto now = fs::file_time_type::clock::now();
+    for (const auto& entry : fs::directory_iterator(path("claimed"), ec)) {
+        std::error_code time_ec;
+        auto touched = fs::last_write_time(entry.path(), time_ec);
+        if (!time_ec && std::chrono::duration<double>(now - touched).count() > lease_seconds) {
+            expired.push_back(entry.path().string());
+        }
+    }
+
+    // A worker whose claim is moved away can still publish its RIBs; the
+    // shard is then simulated twice, with identical results. A claim left
+    // behind by a worker that stopped right after publishing is just dropped.
+    size_t reclaimed = 0;
+    for (const auto& claimed : expired) {
+        std::string name = getShardName(claimed);
+        if (fs::exists(path("ribs/" + name), ec)) {
+            std::remove(claimed.c_str());
+            continue;
+        }
+        if (std::rename(claimed.c_str(), path("pending/" + name).c_str()) == 0) {
+            reclaimed++;
+        }
+    }
+    return reclaimed;
+}
+
+std::string ShardDirectory::getShardName(const std::string& claimed) {
+    // claimed/shard-NNNNN.csv.<worker id>
+    std::string name = fs::path(claimed).filename().string();
+    return name.substr(0, name.find(".csv") + 4);
+}
+
+std::string ShardDirectory::getPartialFile(const std::string& claimed) const {
+    return path("ribs/." + fs::path(claimed).filename().string() + ".tmp");
+}
+
+bool ShardDirectory::complete(const std::string& claimed) {
+    std::string done = path("ribs/" + getShardName(claimed));
+    if (std::rename(getPartialFile(claimed).c_str(), done.c_str()) != 0) {
+        return false;
+    }
+    // The claim is gone already if the lease expired and it was reclaimed
+    std::remove(claimed.c_str());
+    return true;
+}
+
+std::vector<std::string> ShardDirectory::getCompletedFiles() const {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(path("ribs"), ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("shard-", 0) == 0) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+size_t ShardDirectory::getCompletedCount() const {
+    return getCompletedFiles().size();
+}
+
+std::string ShardDirectory::defaultWorkerId() {
+    char host[256] = {};
+    if (gethostname(host, sizeof(host) - 1) != 0) {
+        host[0] = '\0';
+    }
+    return std::string(host[0] ? host : "worker") + "-" + std::to_string(getpid());
+}
+
+ShardLease::ShardLease(ShardDirectory& shards, const std::string& claimed, double renew_seconds) {
+    auto interval = std::chrono::duration<double>(renew_seconds);
+    thread_ = std::thread([this, &shards, claimed, interval]() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_.wait_for(lock, interval, [this]() { return stopping_; })) {
+            shards.renew(claimed);
+        }
+    });
+}
+
+ShardLease::~ShardLease() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_.notify_one();
+    thread_.join();
+}
@@ -0,0 +1,197 @@
+#include "Traceback.h"
+#include <arpa/inet.h>
+#include <iostream>
+#include <optional>
+#include <unordered_set>
+
+namespace {
+
+constexpr uint32_t kNoPrefix = UINT32_MAX;
+
+}  // namespace
+
+Traceback::Traceback(const ASGraph& graph, const std::vector<InputAnnouncement>& announcements,
+                     const PrefixAliases& aliases)
+    : graph_(graph) {
+    for (const auto& [asn, as_ptr] : graph_.getAllASes()) {
+        index_[asn] = static_cast<uint32_t>(asns_.size());
+        asns_.push_back(asn);
+    }
+
+    // Register every announced prefix under the prefix its routes are stored as
+    std::unordered_map<std::string, std::vector<uint32_t>> ids;
+    for (const auto& ann : announcements) {
+        auto [it, inserted] = ids.emplace(ann.prefix, std::vector<uint32_t>());
+        if (inserted) {
+            auto alias = aliases.find(ann.prefix);
+            std::vector<std::string> members = alias != aliases.end()
+                ? alias->second : std::vector<std::string>{ann.prefix};
+            for (const auto& member : members) {
+                size_t slash = member.find('/');
+                bool v6 = false;
+                std::string bytes;
+                if (slash == std::string::npos || !parseAddress(member.substr(0, slash), v6, bytes)) {
+                    std::cerr << "Warning: Traceback skips unparsable prefix " << member << std::endl;
+                    continue;
+                }
+                int length = std::stoi(member.substr(slash + 1));
+                uint32_t id = static_cast<uint32_t>(prefixes_.size());
+                table_[{v6, length}].emplace(mask(bytes, length), id);
+                prefixes_.push_back(member);
+                simulated_.push_back(ann.prefix);
+                it->second.push_back(id);
+            }
+        }
+        if (ann.rov_invalid) {
+            for (uint32_t id : it->second) {
+                attackers_.insert({id, ann.asn});
+            }
+        }
+    }
+}
+
+std::vector<std::string> Traceback::getDefaultProbes() const {
+    std::vector<std::string> probes;
+    std::unordered_set<std::string> seen;
+    for (const auto& prefix : prefixes_) {
+        std::string address = prefix.substr(0, prefix.find('/'));
+        if (seen.insert(address).second) {
+            probes.push_back(address);
+        }
+    }
+    return probes;
+}
+
+bool Traceback::trace(const std::string& address) {
+    bool v6 = false;
+    std::string bytes;
+    if (!parseAddress(address, v6, bytes)) {
+        return false;
+    }
+
+    // Announced prefixes covering the probe, longest first
+    std::vector<uint32_t> covering;
+    for (const auto& [key, entries] : table_) {
+        if (key.first != v6) {
+            continue;
+        }
+        auto it = entries.find(mask(bytes, key.second));
+        if (it != entries.end()) {
+            covering.push_back(it->second);
+        }
+    }
+
+    const size_t n = asns_.size();
+    outcome_.assign(n, Outcome::DISCONNECTED);
+    matched_.assign(n, kNoPrefix);
+    std::vector<uint8_t> state(n, 0);   // 0 = new, 1 = on the current walk, 2 = resolved
+    std::vector<uint8_t> looped(n, 0);
+    std::vector<uint32_t> walk;
+
+    // Follow next hops until an origin, a dead end, a loop or an AS that is
+    // already resolved; everything on the walk shares that outcome
+    for (uint32_t start = 0; start < n; start++) {
+        if (state[start] == 2) {
+            continue;
+        }
+        walk.clear();
+        Outcome result = Outcome::DISCONNECTED;
+        bool loop = false;
+        uint32_t v = start;
+        while (true) {
+            if (state[v] == 2) {
+                result = outcome_[v];
+                loop = looped[v] != 0;
+                break;
+            }
+            if (state[v] == 1) {
+                loop = true;
+                break;
+            }
+            state[v] = 1;
+            walk.push_back(v);
+
+            std::optional<Announcement> route;
+            for (uint32_t id : covering) {
+                route = graph_.findRoute(asns_[v], simulated_[id]);
+                if (route) {
+                    matched_[v] = id;
+                    break;
+                }
+            }
+            if (!route) {
+                break;
+            }
+
+            const auto& path = route->getASPath();
+            if (path.size() <= 1) {
+                result = attackers_.count({matched_[v], asns_[v]}) ? Outcome::ATTACKER
+                                                                   : Outcome::ORIGIN;
+                break;
+            }
+            auto next = index_.find(path[1]);
+            if (next == index_.end()) {
+                break;
+            }
+            v = next->second;
+        }
+
+        for (uint32_t u : walk) {
+            outcome_[u] = result;
+            looped[u] = loop;
+            state[u] = 2;
+        }
+    }
+
+    counts_[0] = counts_[1] = counts_[2] = 0;
+    loops_ = 0;
+    for (uint32_t v = 0; v < n; v++) {
+        counts_[static_cast<size_t>(outcome_[v])]++;
+        loops_ += looped[v];
+    }
+    return true;
+}
+
+void Traceback::writeRows(std::ostream& out, const std::string& probe) const {
+    for (size_t v = 0; v < asns_.size(); v++) {
+        out << probe << "," << asns_[v] << ","
+            << (matched_[v] == kNoPrefix ? "" : prefixes_[matched_[v]]) << ","
+            << getOutcomeName(outcome_[v]) << "\n";
+    }
+}
+
+const char* Traceback::getOutcomeName(Outcome outcome) {
+    switch (outcome) {
+        case Outcome::ORIGIN: return "origin";
+        case Outcome::ATTACKER: return "attacker";
+        default: return "disconnected";
+    }
+}
+
+bool Traceback::parseAddress(const std::string& text, bool& v6, std::string& bytes) {
+    unsigned char buffer[16];
+    if (inet_pton(AF_INET, text.c_str(), buffer) == 1) {
+        v6 = false;
+        bytes.assign(reinterpret_cast<const char*>(buffer), 4);
+        return true;
+    }
+    if (inet_pton(AF_INET6, text.c_str(), buffer) == 1) {
+        v6 = true;
+        bytes.assign(reinterpret_cast<const char*>(buffer), 16);
+        return true;
+    }
+    return false;
+}
+
+std::string Traceback::mask(const std::string& bytes, int length) {
+    std::string masked = bytes;
+    for (size_t i = 0; i < masked.size(); i++) {
+        int bits = length - static_cast<int>(i) * 8;
+        if (bits <= 0) {
+            masked[i] = 0;
+        } else if (bits < 8) {
+            masked[i] = static_cast<char>(masked[i] & (0xFF << (8 - bits)));
+        }
+    }
+    return masked;
+}
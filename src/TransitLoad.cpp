@@ -0,0 +1,114 @@
+#include "TransitLoad.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <utility>
+
+NextHopTreeLoad::NextHopTreeLoad(size_t num_ases) : carried_(num_ases, 0), as_paths_(num_ases, 0) {}
+
+void NextHopTreeLoad::addTree(std::vector<Route>& routes, uint64_t weight) {
+    // Longest path first: every dependent is settled before its next hop
+    std::sort(routes.begin(), routes.end(),
+              [](const Route& a, const Route& b) { return a.length > b.length; });
+    for (const auto& route : routes) {
+        uint64_t through = carried_[route.as] + 1;
+        if (route.hop != kNoHop) {
+            as_paths_[route.as] += (through - 1) * weight;  // Not the origin
+            carried_[route.hop] += through;
+            link_paths_[uint64_t(route.as) << 32 | route.hop] += through * weight;
+        }
+    }
+    for (const auto& route : routes) {
+        carried_[route.as] = 0;
+        if (route.hop != kNoHop) {
+            carried_[route.hop] = 0;
+        }
+    }
+}
+
+TransitLoad::TransitLoad(size_t num_threads) : executor_(std::max<size_t>(num_threads, 1)) {}
+
+void TransitLoad::add(const ASGraph& graph, const PrefixTask* tasks, size_t count,
+                      const PrefixAliases& aliases) {
+    std::vector<const AS*> ases;
+    std::vector<bool> derived;
+    std::unordered_map<uint32_t, uint32_t> index;
+    bool first = asns_.empty();
+    for (const auto& [asn, as] : graph.getAllASes()) {
+        index[asn] = static_cast<uint32_t>(ases.size());
+        ases.push_back(as.get());
+        derived.push_back(graph.isDerived(asn));
+        if (first) {
+            asns_.push_back(asn);
+        }
+    }
+    if (first) {
+        loads_.assign(executor_.getWorkerCount(), NextHopTreeLoad(asns_.size()));
+    }
+
+    std::vector<std::vector<NextHopTreeLoad::Route>> trees(executor_.getWorkerCount());
+    std::vector<double> costs(count);
+    for (size_t p = 0; p < count; p++) {
+        costs[p] = tasks[p].cost;
+    }
+    executor_.run(costs, [&](size_t worker, size_t p) {
+        const std::string& prefix = tasks[p].prefix;
+        auto& tree = trees[worker];
+        tree.clear();
+        auto add_route = [&](uint32_t v, const Announcement& ann) {
+            const auto& path = ann.getASPath();
+            uint32_t hop = NextHopTreeLoad::kNoHop;
+            if (path.size() > 1) {
+                auto next = index.find(path[1]);
+                hop = next != index.end() ? next->second : NextHopTreeLoad::kNoHop;
+            }
+            tree.push_back(NextHopTreeLoad::Route{v, hop, static_cast<uint32_t>(path.size())});
+        };
+        for (uint32_t v = 0; v < ases.size(); v++) {
+            if (derived[v]) {
+                if (auto route = graph.findRoute(ases[v]->getASN(), prefix)) {
+                    add_route(v, *route);
+                }
+                continue;
+            }
+            const auto& table = ases[v]->getRoutingTable();
+            auto route = table.find(prefix);
+            if (route != table.end()) {
+                add_route(v, route->second);
+            }
+        }
+
+        auto alias = aliases.find(prefix);
+        loads_[worker].addTree(tree, alias != aliases.end() ? alias->second.size() : 1);
+    });
+}
+
+bool TransitLoad::writeCSV(const std::string& filename) const {
+    std::map<uint32_t, uint64_t> as_paths;
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> link_paths;
+    for (const auto& load : loads_) {
+        for (size_t v = 0; v < load.getASPaths().size(); v++) {
+            if (load.getASPaths()[v] != 0) {
+                as_paths[asns_[v]] += load.getASPaths()[v];
+            }
+        }
+        for (const auto& [link, paths] : load.getLinkPaths()) {
+            link_paths[{asns_[link >> 32], asns_[static_cast<uint32_t>(link)]}] += paths;
+        }
+    }
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    file << "kind,asn,next_hop,best_paths\n";
+    for (const auto& [asn, paths] : as_paths) {
+        file << "as," << asn << ",," << paths << "\n";
+    }
+    for (const auto& [link, paths] : link_paths) {
+        file << "link," << link.first << "," << link.second << "," << paths << "\n";
+    }
+    return true;
+}
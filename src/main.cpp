@@ -7,10 +7,17 @@
 #include "Aggregation.h"
 #include "Statistics.h"
 #include "CSVOutput.h"
+#include "ShardDirectory.h"
 #include "utils/Downloader.h"
 #include "utils/parser.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <filesystem>
+#include <fstream>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
 
 void testBasicScenario() {
     std::cout << "\n=== Test 1: Single Announcement, Tiny Graph ===" << std::endl;
@@ -293,6 +300,220 @@ void testValleyFreeViolation() {
     std::cout << "✓ Test 5 Complete" << std::endl;
 }
 
+// Every AS's route for prefix must be its next hop's route plus the AS itself
+static bool verifyNextHops(ASGraph& graph, const std::string& prefix) {
+    bool consistent = true;
+    for (const auto& [asn, as_ptr] : graph.getAllASes()) {
+        auto route = as_ptr->getRoutingTable().find(prefix);
+        if (route == as_ptr->getRoutingTable().end()) {
+            std::cout << "  AS" << asn << ": no route" << std::endl;
+            consistent = false;
+            continue;
+        }
+        const auto& path = route->second.getASPath();
+        bool ok = true;
+        if (path.size() > 1) {
+            const auto& hop_table = graph.getAS(path[1])->getRoutingTable();
+            auto hop_route = hop_table.find(prefix);
+            ok = hop_route != hop_table.end() &&
+                 std::equal(path.begin() + 1, path.end(), hop_route->second.getASPath().begin(),
+                            hop_route->second.getASPath().end());
+        }
+        std::cout << "  AS" << asn << " via AS" << path[path.size() > 1 ? 1 : 0]
+                  << (ok ? ": OK" : ": STALE (next hop no longer uses this path)") << std::endl;
+        consistent = consistent && ok;
+    }
+    return consistent;
+}
+
+bool testLeakingPeers() {
+    std::cout << "\n=== Test 6: Two Leaking Peers ===" << std::endl;
+    std::cout << "Goal: Leaked routes that change are withdrawn, leaving no loops" << std::endl;
+    std::cout << std::endl;
+    
+    ASGraph graph;
+    graph.addRelationship(10, 1);        // AS10 -> AS1 (provider)
+    graph.addRelationship(20, 1);        // AS20 -> AS1 (provider)
+    graph.addRelationship(10, 2);        // AS10 -> AS2 (provider)
+    graph.addRelationship(20, 3);        // AS20 -> AS3 (provider)
+    graph.addPeeringRelationship(2, 3);  // AS2 <-> AS3 (peer)
+    
+    std::cout << "Topology:" << std::endl;
+    std::cout << "     AS10    AS20" << std::endl;
+    std::cout << "     /  \\    /  \\" << std::endl;
+    std::cout << "   AS2   AS1    AS3" << std::endl;
+    std::cout << "    \\____peer____/" << std::endl;
+    std::cout << std::endl;
+    
+    // AS1 originates; AS2 and AS3 leak their routes to each other. Each
+    // first prefers the other's leaked peer route, which then loops back
+    // through itself and must be withdrawn.
+    graph.getAS(1)->originatePrefix("10.0.0.0/16");
+    graph.computePropagationRanks();
+    graph.setLeakingASes({2, 3});
+    int rounds = graph.propagateToConvergence();
+    
+    std::cout << "AS1 originates: 10.0.0.0/16 (AS2 and AS3 leak)" << std::endl;
+    std::cout << "Converged after " << rounds << " rounds" << std::endl;
+    std::cout << std::endl;
+    
+    std::cout << "Verification:" << std::endl;
+    bool consistent = verifyNextHops(graph, "10.0.0.0/16");
+    std::cout << std::endl;
+    
+    // Output CSV
+    CSVOutput::writeRoutingTable(graph, "routing_table_test6.csv");
+    std::cout << "CSV Output (routing_table_test6.csv):" << std::endl;
+    std::cout << CSVOutput::generateCSV(graph);
+    std::cout << std::endl;
+    
+    // A ROV adopter originating an invalid announcement keeps its own route
+    // even when a valid one arrives later. Otherwise the three-phase run
+    // leaves its provider with a stale path, while event-driven propagation
+    // withdraws it.
+    auto build_hijack = [](ASGraph& hijack) {
+        hijack.addRelationship(30, 4);        // AS30 -> AS4 (provider)
+        hijack.addPeeringRelationship(4, 5);  // AS4 <-> AS5 (peer)
+        hijack.addRelationship(5, 6);         // AS5 -> AS6 (provider)
+        hijack.getROVValidator().addROA("10.1.0.0/16", 6);
+        for (const auto& [asn, as_ptr] : hijack.getAllASes()) {
+            as_ptr->setROVValidator(&hijack.getROVValidator());
+        }
+        hijack.getAS(4)->setDropInvalid(true);
+        hijack.getAS(6)->originatePrefix("10.1.0.0/16");
+        hijack.getAS(4)->originatePrefix("10.1.0.0/16");
+        hijack.computePropagationRanks();
+    };
+    ASGraph three_phase;
+    build_hijack(three_phase);
+    three_phase.propagateToConvergence();
+    ASGraph event_driven;
+    build_hijack(event_driven);
+    event_driven.setLeakingASes({});
+    event_driven.propagateToConvergence();
+    
+    std::cout << "AS6 originates 10.1.0.0/16; AS4 (ROV) originates it too, ROV-invalid" << std::endl;
+    std::cout << "  AS30 -> AS4 <-peer-> AS5 -> AS6" << std::endl;
+    std::cout << "Verification (three-phase):" << std::endl;
+    bool hijack_ok = verifyNextHops(three_phase, "10.1.0.0/16");
+    std::cout << "Verification (event-driven):" << std::endl;
+    hijack_ok = verifyNextHops(event_driven, "10.1.0.0/16") && hijack_ok;
+    bool same = CSVOutput::generateCSV(three_phase) == CSVOutput::generateCSV(event_driven);
+    std::cout << "  Same RIBs: " << (same ? "YES" : "NO") << std::endl;
+    std::cout << std::endl;
+    consistent = consistent && hijack_ok && same;
+    
+    std::cout << (consistent ? "✓ Test 6 Complete" : "✗ Test 6 Failed") << std::endl;
+    return consistent;
+}
+
+// Publish empty RIBs for a claimed shard, as a worker does after simulating it
+static bool publishShard(ShardDirectory& shards, const std::string& claimed) {
+    std::ofstream(shards.getPartialFile(claimed)) << "asn,prefix,as_path\n";
+    return shards.complete(claimed);
+}
+
+bool testShardLeases() {
+    std::cout << "\n=== Test 7: Shard Leases Across Processes ===" << std::endl;
+    std::cout << "Goal: Only abandoned claims are reclaimed, never finished or renewed ones" << std::endl;
+    std::cout << std::endl;
+    
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / ("bgp_sim_shards_" + std::to_string(getpid()));
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::ofstream(dir / "rel.txt") << "1|2|-1\n";
+    std::ofstream(dir / "ann.csv") << "seed_asn,prefix,rov_invalid\n";
+    std::vector<InputAnnouncement> announcements;
+    for (int i = 0; i < 4; i++) {
+        announcements.emplace_back(2, "10." + std::to_string(i) + ".0.0/16", false);
+    }
+    
+    ShardDirectory shards((dir / "work").string());
+    if (!shards.create((dir / "rel.txt").string(), (dir / "ann.csv").string(), "", "",
+                       TieBreak::LOWEST_NEIGHBOR_ASN, announcements, 4)) {
+        std::cout << "✗ Test 7 Failed (could not create the shard directory)" << std::endl;
+        return false;
+    }
+    
+    // A slow worker renews its claim for well past the lease before
+    // publishing; a crashed one claims a shard and exits
+    const double lease_seconds = 0.3;
+    pid_t slow = fork();
+    if (slow == 0) {
+        ShardDirectory worker((dir / "work").string());
+        std::string claimed = worker.load() ? worker.claim("slow") : "";
+        if (claimed.empty()) {
+            _exit(1);
+        }
+        {
+            ShardLease lease(worker, claimed, 0.05);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+        }
+        _exit(publishShard(worker, claimed) ? 0 : 1);
+    }
+    pid_t crashed = fork();
+    if (crashed == 0) {
+        ShardDirectory worker((dir / "work").string());
+        _exit(worker.load() && !worker.claim("crashed").empty() ? 0 : 1);
+    }
+    int crashed_status = 0;
+    waitpid(crashed, &crashed_status, 0);
+    auto slow_claimed = [&]() {
+        for (const auto& entry : fs::directory_iterator(dir / "work" / "claimed")) {
+            if (entry.path().extension() == ".slow") {
+                return true;
+            }
+        }
+        return false;
+    };
+    auto start = std::chrono::steady_clock::now();
+    while (!slow_claimed() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    std::cout << "Topology: 4 shards; a slow worker (renewing) and a crashed worker hold one each" << std::endl;
+    std::cout << "Lease: " << lease_seconds << "s" << std::endl;
+    std::cout << std::endl;
+    
+    // The coordinator's side: finish what it can claim, then keep reclaiming
+    // expired claims until every shard is published
+    bool published = true;
+    size_t reclaimed = 0;
+    int slow_status = 0;
+    bool slow_done = false;
+    start = std::chrono::steady_clock::now();
+    while (shards.getCompletedCount() < shards.getShardCount() &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        for (std::string claimed = shards.claim("coordinator"); !claimed.empty();
+             claimed = shards.claim("coordinator")) {
+            published = publishShard(shards, claimed) && published;
+        }
+        reclaimed += shards.reclaimExpired(lease_seconds);
+        slow_done = slow_done || waitpid(slow, &slow_status, WNOHANG) == slow;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    if (!slow_done) {
+        waitpid(slow, &slow_status, 0);
+    }
+    
+    bool workers_ok = WIFEXITED(slow_status) && WEXITSTATUS(slow_status) == 0 &&
+                      WIFEXITED(crashed_status) && WEXITSTATUS(crashed_status) == 0;
+    bool claims_left = !fs::is_empty(dir / "work" / "claimed") || !fs::is_empty(dir / "work" / "pending");
+    std::cout << "Verification:" << std::endl;
+    std::cout << "  Shards published: " << shards.getCompletedCount() << "/" << shards.getShardCount()
+              << std::endl;
+    std::cout << "  Claims reclaimed: " << reclaimed << " (expected 1, the crashed worker's)" << std::endl;
+    std::cout << "  Claims left behind: " << (claims_left ? "YES" : "NO") << std::endl;
+    std::cout << std::endl;
+    bool ok = workers_ok && published && reclaimed == 1 && !claims_left &&
+              shards.getCompletedCount() == shards.getShardCount();
+    fs::remove_all(dir);
+    
+    std::cout << (ok ? "✓ Test 7 Complete" : "✗ Test 7 Failed") << std::endl;
+    return ok;
+}
+
 int main() {
     std::cout << "╔════════════════════════════════════════════════════════════╗" << std::endl;
     std::cout << "║                                                            ║" << std::endl;
@@ -311,6 +532,8 @@ int main() {
     testConflictingAnnouncements();
     testPrefixHijack();
     testValleyFreeViolation();
+    bool leaks_ok = testLeakingPeers();
+    bool shards_ok = testShardLeases();
     
     std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
     std::cout << "║                                                            ║" << std::endl;
@@ -324,7 +547,8 @@ int main() {
     std::cout << "  - routing_table_test3.csv (conflicting announcements)" << std::endl;
     std::cout << "  - routing_table_test4.csv (prefix hijacking)" << std::endl;
     std::cout << "  - routing_table_test5.csv (valley-free policy)" << std::endl;
+    std::cout << "  - routing_table_test6.csv (leaking peers)" << std::endl;
     std::cout << std::endl;
     
-    return 0;
+    return leaks_ok && shards_ok ? 0 : 1;
 }
\ No newline at end of file
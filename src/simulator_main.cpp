@@ -1,15 +1,54 @@
 #include "AS.h"
 #include "ASGraph.h"
+#include "AdoptionSweep.h"
 #include "Announcement.h"
+#include "BestPath.h"
+#include "BoundedQueue.h"
 #include "Policy.h"
 #include "ROV.h"
+#include "ROVPlacement.h"
+#include "RouteSolver.h"
 #include "CSVOutput.h"
 #include "CSVInput.h"
+#include "IncrementalSimulation.h"
+#include "IndexedGraph.h"
+#include "PathMatrix.h"
+#include "LinkFailureSweep.h"
+#include "PrefixBlock.h"
+#include "PrefixClasses.h"
+#include "PropagationRunner.h"
+#include "Reachability.h"
+#include "ScenarioRunner.h"
+#include "RouteLeaks.h"
+#include "RouteSummary.h"
+#include "Scheduler.h"
+#include "Traceback.h"
+#include "TransitLoad.h"
+#include "ShardDirectory.h"
 #include "utils/Downloader.h"
 #include "utils/parser.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <sys/resource.h>
 
 void printUsage(const char* program_name) {
     std::cout << "BGP Simulator - Cloudflare Network Optimization Tool\n";
@@ -19,6 +58,78 @@ void printUsage(const char* program_name) {
     std::cout << "  --announcements <path>   Path to announcements CSV file\n";
     std::cout << "  --rov-asns <path>        Path to ROV ASNs CSV file\n";
     std::cout << "  --output <path>          Path to output CSV file (default: ribs.csv)\n";
+    std::cout << "  --engine <name>          Propagation engine: inbox (default), vector or bfs\n";
+    std::cout << "  --block-size <n>         Prefixes per block for --engine vector: 8, 16 (default) or 32\n";
+    std::cout << "  --batch-size <n>         Simulate and write n prefixes at a time, freeing RIBs\n";
+    std::cout << "                           between batches (default: all at once)\n";
+    std::cout << "  --max-memory <MB>        Pick the batch size to stay near this memory target\n";
+    std::cout << "  --vantage-asns <path>    Only compute and write the RIBs of these ASes (one per line)\n";
+    std::cout << "  --compact                Skip stub ASes and ASes with identical neighbors during\n";
+    std::cout << "                           propagation; their routes are derived when writing output\n";
+    std::cout << "  --no-prefix-classes      Simulate every prefix, even ones with identical origins\n";
+    std::cout << "  --tie-break <rule>       Final tie-break: lowest-asn (default) or oldest\n";
+    std::cout << "  --threads <n>            Simulate prefixes on n work-stealing workers\n";
+    std::cout << "                           (default: 1, 0 = hardware concurrency)\n";
+    std::cout << "  --reachability <path>    Skip RIBs; write per-origin reachability counts\n";
+    std::cout << "                           (origins: announcement ASNs, or every AS if none given)\n";
+    std::cout << "  --reachability-matrix <path>  Also write asn,origin,relationship rows\n";
+    std::cout << "  --path-matrix <path>     Skip RIBs; write every AS's next hop toward each origin\n";
+    std::cout << "                           (origins as for --reachability) to a memory-mapped matrix\n";
+    std::cout << "  --path-lookup <path>     Print AS paths rebuilt from a path matrix (no other input)\n";
+    std::cout << "    --pairs <s:o,...>      Source:origin ASN pairs to look up\n";
+    std::cout << "  --shard-dir <dir>        Shared directory for a multi-process run, with one of:\n";
+    std::cout << "    --shards <n>           coordinator: split the prefixes into n shards, work on\n";
+    std::cout << "                           them and merge every shard's RIBs into --output\n";
+    std::cout << "    --worker               worker: claim and simulate shards until none are left\n";
+    std::cout << "  --worker-id <id>         Name used in shard claims (default: hostname-pid)\n";
+    std::cout << "  --shard-timeout <s>      Coordinator gives up when no shard completes for s seconds\n";
+    std::cout << "                           (default: 1800); claims not renewed for 60s are retried\n";
+    std::cout << "  --what-if <path>         Converge once, then apply each change listed in the file\n";
+    std::cout << "                           (remove-link A B, add-provider-link P C, add-peer-link A B,\n";
+    std::cout << "                           rov-on A, rov-off A) incrementally; --output gets the RIBs\n";
+    std::cout << "                           after the last change\n";
+    std::cout << "  --what-if-output <path>  Changed routes per change (default: what_if.csv)\n";
+    std::cout << "  --what-if-check <n>      Apply n random changes drawn with --seed incrementally and\n";
+    std::cout << "                           check every route against a full re-solve after each\n";
+    std::cout << "  --rov-scenarios <path>   After the baseline run, re-simulate the prefixes with a\n";
+    std::cout << "                           ROV-invalid origin under each ROV ASNs file listed (one\n";
+    std::cout << "                           per line); writes <output>.<scenario>.csv per scenario\n";
+    std::cout << "  --scenarios <path>       Run every scenario in the manifest (name,announcements[,rov_asns]\n";
+    std::cout << "                           per line) concurrently against one shared graph; writes\n";
+    std::cout << "                           <output>.<name>.csv per scenario\n";
+    std::cout << "  --rov-sweep <pcts>       Monte Carlo ROV adoption: for each percentage (e.g. 0,10,50),\n";
+    std::cout << "                           random adopter sets; writes hijack outcome means and 95%\n";
+    std::cout << "                           confidence intervals instead of RIBs\n";
+    std::cout << "    --trials <n>           Trials per percentage (default: 10)\n";
+    std::cout << "    --seed <n>             Random seed (default: 1)\n";
+    std::cout << "    --weight-by-cone       Sample adopters weighted by customer-cone size\n";
+    std::cout << "    --sweep-output <path>  Sweep results (default: rov_sweep.csv)\n";
+    std::cout << "  --rov-placement <k>      Greedily pick the k ASes whose ROV deployment protects the\n";
+    std::cout << "                           most routes, on top of --rov-asns\n";
+    std::cout << "    --placement-output <path>  Ranked adopters (default: rov_placement.csv)\n";
+    std::cout << "  --link-sweep <k|all>     Fail each of the k links with the most transit load (or every\n";
+    std::cout << "                           loaded link) and count the routes that change\n";
+    std::cout << "    --link-sweep-output <path>  Ranked link criticality (default: link_criticality.csv)\n";
+    std::cout << "  --route-leaks <prefix>   Let each candidate AS leak its provider or peer route for the\n";
+    std::cout << "                           prefix to its providers and peers, one leaker at a time\n";
+    std::cout << "    --leakers <path>       Leaker ASNs (default: every AS holding such a route)\n";
+    std::cout << "    --leak-sample <n>      Evaluate n leakers drawn with --seed\n";
+    std::cout << "    --leak-output <path>   Adopting ASes per leaker (default: route_leaks.csv)\n";
+    std::cout << "  --leak-asns <path>       ASes that leak in this run: they export provider and peer\n";
+    std::cout << "                           routes to their providers and peers (inbox engine)\n";
+    std::cout << "  --summary <path>         Write per-prefix, per-origin AS counts (by ROV policy and\n";
+    std::cout << "                           relationship) instead of the RIBs\n";
+    std::cout << "  --cones <path>           Also write every AS's customer cone (asn followed by its\n";
+    std::cout << "                           cone members, one AS per line)\n";
+    std::cout << "  --transit-load <path>    Also write how many best paths cross each AS and each\n";
+    std::cout << "                           directed link, counted from the next hops\n";
+    std::cout << "  --alternates <path>      Also keep each AS's next-best routes per prefix (inbox engine)\n";
+    std::cout << "                           and write asn,prefix,rank,as_path rows\n";
+    std::cout << "    --alternates-k <k>     Backup routes kept per AS and prefix, 1-4 (default: 2)\n";
+    std::cout << "    --alternates-budget-mb <n>  Memory for backup routes (default: 1024, 0 = unbounded)\n";
+    std::cout << "  --traceback <path>       After the run, follow longest-prefix-match next hops from\n";
+    std::cout << "                           every AS and write probe,asn,prefix,outcome rows\n";
+    std::cout << "    --probes <addrs>       Probe addresses (default: every announced prefix's address)\n";
     std::cout << "  --help                   Show this help message\n";
     std::cout << "\nExample:\n";
     std::cout << "  " << program_name << " --relationships relationships.txt \\\n";
@@ -27,57 +138,305 @@ void printUsage(const char* program_name) {
     std::cout << "    --output ribs.csv\n";
 }
 
-int main(int argc, char* argv[]) {
+// Inputs and options of one simulation run; shard workers fill in the
+// files per shard
+struct SimulationConfig {
     std::string caida_file;
     std::string announcements_file;
+    std::string roa_file;  // ROAs come from these announcements when set
     std::string rov_asns_file;
     std::string output_file = "ribs.csv";
-    
-    // Parse command-line arguments
-    for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
-        
-        if (arg == "--help" || arg == "-h") {
-            printUsage(argv[0]);
-            return 0;
-        } else if (arg == "--relationships" && i + 1 < argc) {
-            caida_file = argv[++i];
-        } else if (arg == "--announcements" && i + 1 < argc) {
-            announcements_file = argv[++i];
-        } else if (arg == "--rov-asns" && i + 1 < argc) {
-            rov_asns_file = argv[++i];
-        } else if (arg == "--output" && i + 1 < argc) {
-            output_file = argv[++i];
-        } else {
-            std::cerr << "Unknown option: " << arg << std::endl;
-            printUsage(argv[0]);
+    size_t num_threads = 1;
+    TieBreak tie_break = TieBreak::LOWEST_NEIGHBOR_ASN;
+    std::string engine = "inbox";
+    size_t block_size = 16;
+    bool prefix_classes = true;
+    bool compact = false;
+    size_t batch_size = 0;
+    size_t max_memory_mb = 0;
+    std::string vantage_file;
+    std::string what_if_file;
+    std::string what_if_output = "what_if.csv";
+    size_t what_if_check = 0;
+    std::string rov_scenarios_file;
+    std::vector<double> sweep_percents;
+    size_t sweep_trials = 10;
+    uint64_t sweep_seed = 1;
+    bool sweep_cone_weighted = false;
+    std::string sweep_output = "rov_sweep.csv";
+    std::string traceback_file;
+    std::vector<std::string> probes;
+    std::string summary_file;
+    std::string transit_load_file;
+    std::string cones_file;
+    size_t placement_k = 0;
+    std::string placement_output = "rov_placement.csv";
+    bool link_sweep = false;
+    size_t link_sweep_k = 0;  // 0: every loaded link
+    std::string link_sweep_output = "link_criticality.csv";
+    std::string leak_prefix;
+    std::string leakers_file;
+    size_t leak_sample = 0;
+    std::string leak_output = "route_leaks.csv";
+    std::string leak_asns_file;
+    std::string alternates_file;
+    size_t alternates_k = 2;
+    size_t alternates_budget_mb = 1024;
+};
+
+// How long a worker waits for the coordinator to publish the shards
+const int kManifestWaitSeconds = 60;
+
+// Shard claims are renewed every kLeaseRenewSeconds while a worker is busy
+// with them and count as abandoned after kShardLeaseSeconds without renewal
+const double kLeaseRenewSeconds = 10;
+const double kShardLeaseSeconds = 60;
+
+// Default for --shard-timeout: the coordinator gives up after this long
+// without a shard completing
+const size_t kShardTimeoutSeconds = 1800;
+
+// Finished batches that may wait for the writer while the next one
+// propagates; each holds a full batch of routes
+const size_t kWriteBuffers = 1;
+
+using Clock = std::chrono::steady_clock;
+
+// Value of a numeric option: false (with an error naming the option) unless
+// all of text is a number that fits T
+template <typename T>
+bool parseNumber(const std::string& option, const std::string& text, T& value) {
+    bool ok = false;
+    if constexpr (std::is_floating_point_v<T>) {
+        char* end = nullptr;
+        double parsed = std::strtod(text.c_str(), &end);
+        ok = !text.empty() && end == text.c_str() + text.size() && std::isfinite(parsed);
+        value = static_cast<T>(parsed);
+    } else {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        ok = !text.empty() && error == std::errc() && end == text.data() + text.size();
+    }
+    if (!ok) {
+        std::cerr << "Error: " << option << " expects a number, got '" << text << "'\n";
+    }
+    return ok;
+}
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Peak resident set size of this process so far
+size_t peakMemoryMB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss) / (1024 * 1024);  // bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) / 1024;           // kilobytes
+#endif
+}
+
+// Prefixes per batch that keep the RIBs within max_memory_mb, on top of
+// what the graph, ROAs, announcements and engine already use. Every active
+// AS ends up holding roughly one route per prefix, in the batch being
+// simulated and in each of the written_batches waiting for the writer.
+size_t estimateBatchSize(const ASGraph& graph, size_t max_memory_mb,
+                         const PropagationRunner& runner, size_t written_batches) {
+    size_t active = 0;
+    for (const auto& [asn, as_ptr] : graph.getAllASes()) {
+        active += as_ptr->isActive() ? 1 : 0;
+    }
+
+    active = std::max<size_t>(active, 1);
+
+    size_t reserved = (peakMemoryMB() << 20) + active * runner.getScratchBytesPerAS();
+    size_t target = max_memory_mb << 20;
+    size_t budget = target > reserved ? target - reserved : 0;
+    size_t bytes_per_prefix = runner.getBytesPerRoute() +
+                              PropagationRunner::kInstalledRouteBytes * written_batches;
+    return std::max<size_t>(1, budget / (active * bytes_per_prefix));
+}
+
+// Dense indices of the announcements' origins, or of every AS without a file
+std::vector<uint32_t> collectOrigins(const IndexedGraph& indexed, const std::string& announcements_file) {
+    std::vector<uint32_t> origins;
+    if (announcements_file.empty()) {
+        for (uint32_t v = 0; v < indexed.size(); v++) {
+            origins.push_back(v);
+        }
+    } else {
+        std::unordered_set<uint32_t> seen;
+        for (const auto& ann : CSVInput::parseAnnouncements(announcements_file)) {
+            uint32_t index = indexed.getIndex(ann.asn);
+            if (index != IndexedGraph::kNoIndex && seen.insert(index).second) {
+                origins.push_back(index);
+            }
+        }
+    }
+    return origins;
+}
+
+// Reachability-only mode: 64 origins per bit-parallel pass, no paths or RIBs
+int runReachability(const ASGraph& graph, const std::string& announcements_file,
+                    const std::string& summary_file, const std::string& matrix_file,
+                    size_t num_threads) {
+    std::cout << "Computing Reachability (no RIBs)...\n";
+    IndexedGraph indexed(graph);
+    std::vector<uint32_t> origins = collectOrigins(indexed, announcements_file);
+
+    const size_t per_pass = ReachabilityEngine::kOriginsPerPass;
+    size_t num_passes = (origins.size() + per_pass - 1) / per_pass;
+    std::cout << "  " << origins.size() << " origins in " << num_passes << " passes of "
+              << per_pass << "\n";
+
+    std::vector<std::unique_ptr<ReachabilityEngine>> engines;
+    for (size_t w = 0; w < num_threads; w++) {
+        engines.push_back(std::make_unique<ReachabilityEngine>(indexed));
+    }
+
+    // Passes finish out of order; keep each pass's rows and write them in order
+    std::vector<std::string> summary_rows(num_passes);
+    std::vector<std::string> matrix_rows(num_passes);
+    WorkStealingExecutor executor(num_threads);
+    std::vector<double> costs(num_passes, 1.0);
+
+    executor.run(costs, [&](size_t worker, size_t pass) {
+        size_t first = pass * per_pass;
+        size_t count = std::min(per_pass, origins.size() - first);
+        ReachabilityEngine& engine = *engines[worker];
+        engine.runPass(&origins[first], count);
+
+        std::ostringstream summary;
+        engine.writeSummaryRows(summary);
+        summary_rows[pass] = summary.str();
+        if (!matrix_file.empty()) {
+            std::ostringstream matrix;
+            engine.writeMatrixRows(matrix);
+            matrix_rows[pass] = matrix.str();
+        }
+    });
+
+    std::cout << "  Finished in " << executor.getWallSeconds() << "s\n";
+    if (num_threads > 1) {
+        std::cout << executor.getSummary();
+    }
+
+    auto write_rows = [](const std::string& filename, const char* header,
+                         const std::vector<std::string>& rows) {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << filename << std::endl;
+            return false;
+        }
+        file << header;
+        for (const auto& chunk : rows) {
+            file << chunk;
+        }
+        return true;
+    };
+
+    if (!summary_file.empty()) {
+        if (!write_rows(summary_file, "origin,customer,peer,provider,unreachable\n", summary_rows)) {
             return 1;
         }
+        std::cout << "  Summary file: " << summary_file << "\n";
     }
-    
-    // Validate required arguments
-    if (caida_file.empty()) {
-        std::cerr << "Error: --relationships is required\n";
-        printUsage(argv[0]);
+    if (!matrix_file.empty()) {
+        if (!write_rows(matrix_file, "asn,origin,relationship\n", matrix_rows)) {
+            return 1;
+        }
+        std::cout << "  Matrix file: " << matrix_file << "\n";
+    }
+    std::cout << "  ✓ Reachability complete\n";
+
+    return 0;
+}
+
+// All-origins mode: one route solve per origin on a shared IndexedGraph,
+// keeping only each AS's next hop in a memory-mapped matrix
+int runPathMatrix(const ASGraph& graph, const std::string& announcements_file,
+                  const std::string& matrix_file, size_t num_threads) {
+    std::cout << "Computing All-Origins Path Matrix...\n";
+    IndexedGraph indexed(graph);
+    std::vector<uint32_t> origins = collectOrigins(indexed, announcements_file);
+    std::vector<uint32_t> asns(indexed.size());
+    for (uint32_t v = 0; v < indexed.size(); v++) {
+        asns[v] = indexed.getASN(v);
+    }
+
+    PathMatrix matrix;
+    if (!matrix.create(matrix_file, asns, origins)) {
         return 1;
     }
-    
-    if (announcements_file.empty()) {
-        std::cerr << "Error: --announcements is required\n";
-        printUsage(argv[0]);
+    std::cout << "  " << origins.size() << " origins x " << asns.size() << " ASes ("
+              << origins.size() * asns.size() * sizeof(uint32_t) / (1024 * 1024) << " MB of next hops)\n";
+
+    // No ROAs: every route is unknown, so ROV never drops one
+    ROVValidator validator;
+    std::vector<std::unique_ptr<RouteSolver>> solvers;
+    for (size_t w = 0; w < num_threads; w++) {
+        solvers.push_back(std::make_unique<RouteSolver>(indexed, validator));
+    }
+    WorkStealingExecutor executor(num_threads);
+    std::vector<double> costs(origins.size(), 1.0);
+    executor.run(costs, [&](size_t worker, size_t slot) {
+        RouteSolver& solver = *solvers[worker];
+        PrefixTask task{"0.0.0.0/0", {InputAnnouncement(asns[origins[slot]], "0.0.0.0/0", false)}, 0.0};
+        solver.compute(task);
+        uint32_t* column = matrix.getColumn(slot);
+        std::fill(column, column + asns.size(), PathMatrix::kNoRoute);
+        for (uint32_t v : solver.getReached()) {
+            column[v] = ~static_cast<uint32_t>(solver.getKey(v));  // Next hop (self for the origin)
+        }
+    });
+
+    std::cout << "  Finished in " << executor.getWallSeconds() << "s\n";
+    if (num_threads > 1) {
+        std::cout << executor.getSummary();
+    }
+    if (!matrix.close()) {
+        std::cerr << "Error: Failed to write path matrix " << matrix_file << "\n";
         return 1;
     }
-    
-    std::cout << "╔════════════════════════════════════════════════════════════╗\n";
-    std::cout << "║                                                            ║\n";
-    std::cout << "║           BGP SIMULATOR - CLOUDFLARE EDITION               ║\n";
-    std::cout << "║                                                            ║\n";
-    std::cout << "╚════════════════════════════════════════════════════════════╝\n\n";
-    
+    std::cout << "  Matrix file: " << matrix_file << "\n";
+    std::cout << "  ✓ Path matrix complete\n";
+    return 0;
+}
+
+// Rebuild AS paths from a path matrix, one source:origin pair at a time
+int runPathLookup(const std::string& matrix_file, const std::vector<std::string>& pairs) {
+    PathMatrix matrix;
+    if (!matrix.open(matrix_file)) {
+        return 1;
+    }
+    std::cout << "source,origin,as_path\n";
+    for (const auto& pair : pairs) {
+        size_t colon = pair.find(':');
+        if (colon == std::string::npos) {
+            std::cerr << "Error: Expected source:origin, got " << pair << "\n";
+            return 1;
+        }
+        uint32_t source = 0;
+        uint32_t origin = 0;
+        if (!parseNumber("--pairs", pair.substr(0, colon), source) ||
+            !parseNumber("--pairs", pair.substr(colon + 1), origin)) {
+            return 1;
+        }
+        std::cout << source << "," << origin << ",\"(";
+        auto path = matrix.getPath(source, origin);
+        for (size_t i = 0; i < path.size(); i++) {
+            std::cout << (i ? ", " : "") << path[i];
+        }
+        std::cout << (path.size() == 1 ? ",)" : ")") << "\"\n";
+    }
+    return 0;
+}
+
+// Step 1, shared by every mode. Returns 0, or the exit code on failure.
+int loadGraph(const std::string& caida_file, ASGraph& graph) {
     // Step 1: Build AS Graph from CAIDA data
     std::cout << "[1/5] Loading CAIDA AS Relationships...\n";
-    ASGraph graph;
-    
     if (!CAIDAParser::parseFile(caida_file, graph)) {
         std::cerr << "Error: Failed to parse CAIDA file\n";
         return 1;
@@ -104,156 +463,1558 @@ int main(int argc, char* argv[]) {
     // Compute propagation ranks for hierarchical propagation
     graph.computePropagationRanks();
     std::cout << "  Computed " << graph.getPropagationRanks().size() << " propagation ranks\n";
+
+    // Cone sizes feed the prefix cost model and cone-weighted sampling
+    auto cones_start = Clock::now();
+    graph.computeCustomerCones();
+    std::cout << "  Computed customer cones in " << secondsSince(cones_start) << "s ("
+              << graph.getCustomerConeMemoryBytes() / (1024 * 1024) << " MB)\n";
     std::cout << "  ✓ AS Graph constructed\n\n";
-    
-    // Step 2: Load ROV ASNs (optional)
-    std::cout << "[2/5] Loading ROV ASNs...\n";
-    std::unordered_set<uint32_t> rov_asns_set;
 
-    // Set ROV validator for ALL ASes so they can check ROV state
-    for (const auto& [asn, as_ptr] : graph.getAllASes()) {
-        as_ptr->setROVValidator(&graph.getROVValidator());
+    return 0;
+}
+
+// What-if mode: converge once, then apply each change incrementally and
+// write the routes it changed
+int runWhatIf(const SimulationConfig& config, ASGraph& graph,
+              const std::vector<InputAnnouncement>& announcements, const PrefixAliases& aliases) {
+    std::ifstream changes_file(config.what_if_file);
+    if (!changes_file.is_open()) {
+        std::cerr << "Error: Could not open what-if file: " << config.what_if_file << "\n";
+        return 1;
+    }
+    std::vector<IncrementalSimulation::Change> changes;
+    std::string line;
+    for (int line_num = 1; std::getline(changes_file, line); line_num++) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') {
+            continue;
+        }
+        if (auto change = IncrementalSimulation::Change::parse(line)) {
+            changes.push_back(*change);
+        } else {
+            std::cerr << "Warning: Could not parse what-if line " << line_num << ": " << line << "\n";
+        }
     }
 
-    if (!rov_asns_file.empty()) {
-        auto rov_asns = CSVInput::parseROVASNs(rov_asns_file);
-        rov_asns_set.insert(rov_asns.begin(), rov_asns.end());
-        std::cout << "  Loaded " << rov_asns_set.size() << " ROV ASNs\n";
+    std::cout << "  Running incremental route solver...\n";
+    auto start = Clock::now();
+    IncrementalSimulation simulation(graph, announcements, config.num_threads);
+    std::cout << "  Converged " << simulation.getPrefixCount() << " prefixes in "
+              << secondsSince(start) << "s\n";
+    std::cout << "  ✓ Propagation complete\n\n";
 
-        // Enable ROV filtering ONLY on ROV ASes - drop INVALID routes
-        for (uint32_t asn : rov_asns_set) {
-            AS* as = graph.getAS(asn);
-            if (as) {
-                as->setDropInvalid(true);
-            }
+    std::cout << "[5/5] Applying What-If Changes...\n";
+    std::ofstream out(config.what_if_output);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open file " << config.what_if_output << "\n";
+        return 1;
+    }
+    out << "change,asn,prefix,old_path,new_path\n";
+
+    // Each change builds on the previous ones
+    for (const auto& change : changes) {
+        if (!simulation.isApplicable(change)) {
+            std::cout << "  " << change.describe()
+                      << ": skipped (unknown AS, link already in that state, or a provider link"
+                      << " that would close a provider cycle)\n";
+            continue;
         }
-    } else {
-        std::cout << "  No ROV ASNs file provided (optional)\n";
+        auto change_start = Clock::now();
+        auto changed = simulation.apply(change);
+        double seconds = secondsSince(change_start);
+        CSVOutput::writeRouteChanges(out, change.describe(), changed, aliases);
+
+        size_t routes = 0;
+        for (const auto& route : changed) {
+            auto alias = aliases.find(route.prefix);
+            routes += alias != aliases.end() ? alias->second.size() : 1;
+        }
+        std::cout << "  " << change.describe() << ": " << routes << " routes changed in "
+                  << seconds << "s\n";
     }
-    std::cout << "  ✓ ROV configuration complete\n\n";
-    
-    // Step 3: Load and seed announcements
-    std::cout << "[3/5] Loading Announcements...\n";
-    auto announcements = CSVInput::parseAnnouncements(announcements_file);
-    
-    if (announcements.empty()) {
-        std::cerr << "Error: No announcements loaded\n";
+    out.close();
+
+    simulation.installRoutes(graph);
+    if (!CSVOutput::writeRoutingTable(graph, config.output_file, aliases)) {
+        std::cerr << "Error: Failed to write output CSV\n";
         return 1;
     }
-    
-    std::cout << "  Loaded " << announcements.size() << " announcements\n";
-    std::cout << "  ✓ Announcements parsed\n\n";
-    
-    // Step 4: Seed announcements into the graph
-    std::cout << "[4/5] Seeding Announcements and Simulating Propagation...\n";
-    int seeded = 0;
-    int skipped = 0;
+    std::cout << "  Changed routes: " << config.what_if_output << "\n";
+    std::cout << "  Output file (after all changes): " << config.output_file << "\n";
+    std::cout << "  ✓ What-if analysis complete\n\n";
+    return 0;
+}
 
-    // First, create ROAs for valid announcements
-    for (const auto& input_ann : announcements) {
-        if (!input_ann.rov_invalid) {
-            // Add ROA for valid announcement
-            graph.getROVValidator().addROA(input_ann.prefix, input_ann.asn);
+// What-if self-check: apply random changes and, after each, compare
+// evaluate() with apply() and the resident routes with a full re-solve
+int runWhatIfCheck(const SimulationConfig& config, const ASGraph& graph,
+                   const std::vector<InputAnnouncement>& announcements) {
+    std::cout << "  Running incremental route solver...\n";
+    auto start = Clock::now();
+    IncrementalSimulation simulation(graph, announcements, config.num_threads);
+    std::cout << "  Converged " << simulation.getPrefixCount() << " prefixes in "
+              << secondsSince(start) << "s\n";
+    std::cout << "  ✓ Propagation complete\n\n";
+
+    std::cout << "[5/5] Checking " << config.what_if_check << " Random What-If Changes...\n";
+    using Change = IncrementalSimulation::Change;
+    std::vector<const AS*> ases;
+    for (const auto& [asn, as_ptr] : graph.getAllASes()) {
+        if (as_ptr->isActive()) {
+            ases.push_back(as_ptr.get());
+        }
+    }
+    std::mt19937_64 rng(config.sweep_seed);
+    auto draw = [&]() {
+        const AS* a = ases[rng() % ases.size()];
+        uint32_t b = ases[rng() % ases.size()]->getASN();
+        switch (rng() % 4) {
+            case 0: {
+                // A random pair is rarely linked, so remove one of a's links
+                std::vector<AS*> neighbors = a->getProviders();
+                neighbors.insert(neighbors.end(), a->getCustomers().begin(), a->getCustomers().end());
+                neighbors.insert(neighbors.end(), a->getPeers().begin(), a->getPeers().end());
+                if (!neighbors.empty()) {
+                    b = neighbors[rng() % neighbors.size()]->getASN();
+                }
+                return Change::removeLink(a->getASN(), b);
+            }
+            case 1: return Change::addProviderLink(a->getASN(), b);
+            case 2: return Change::addPeerLink(a->getASN(), b);
+            default: return Change::setROV(a->getASN(), rng() % 2 == 0);
+        }
+    };
+    auto same = [](const RouteChange& x, const RouteChange& y) {
+        return x.asn == y.asn && x.prefix == y.prefix && x.old_path == y.old_path &&
+               x.new_path == y.new_path;
+    };
+
+    size_t failures = 0;
+    for (size_t i = 0; i < config.what_if_check; i++) {
+        Change change = draw();
+        while (!simulation.isApplicable(change)) {
+            change = draw();
         }
+        auto evaluated = simulation.evaluate(change);
+        auto applied = simulation.apply(change);
+        bool consistent = evaluated.size() == applied.size() &&
+                          std::equal(evaluated.begin(), evaluated.end(), applied.begin(), same);
+        size_t mismatches = simulation.verify(config.num_threads);
+        std::cout << "  " << change.describe() << ": " << applied.size() << " routes changed, "
+                  << (consistent ? "evaluate matches" : "evaluate differs") << ", " << mismatches
+                  << " routes differ from a full re-solve\n";
+        failures += !consistent || mismatches > 0;
+    }
+    if (failures > 0) {
+        std::cerr << "Error: " << failures << " of " << config.what_if_check
+                  << " changes left routes that differ\n";
+        return 1;
     }
+    std::cout << "  ✓ What-if check passed\n\n";
+    return 0;
+}
 
-    for (const auto& input_ann : announcements) {
-        AS* origin_as = graph.getAS(input_ann.asn);
+// <output stem>.<scenario>.csv, e.g. ribs.rov_tier1.csv
+std::string getScenarioOutputFile(const std::string& output_file, const std::string& scenario) {
+    std::string stem = output_file;
+    if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".csv") == 0) {
+        stem.resize(stem.size() - 4);
+    }
+    return stem + "." + scenario + ".csv";
+}
 
-        if (!origin_as) {
-            skipped++;
-            continue;
+// ROV-deployment scenarios. drop_invalid only fires on INVALID routes, so a
+// prefix without a ROV-invalid origin routes the same under every ROV set:
+// its baseline routes are written once and merged into every scenario's
+// output, and each scenario re-simulates only the remaining prefixes.
+int runROVScenarios(const SimulationConfig& config, ASGraph& graph,
+                    const std::vector<InputAnnouncement>& announcements,
+                    const PrefixAliases& aliases) {
+    std::ifstream list(config.rov_scenarios_file);
+    if (!list.is_open()) {
+        std::cerr << "Error: Could not open ROV scenarios file: " << config.rov_scenarios_file << "\n";
+        return 1;
+    }
+    std::vector<std::string> scenarios;
+    std::string line;
+    while (std::getline(list, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty() && line[0] != '#') {
+            scenarios.push_back(line);
         }
+    }
 
-        // Originate all announcements (including invalid ones)
-        // ROV-enabled ASes will drop invalid routes during propagation
-        origin_as->originatePrefix(input_ann.prefix);
-        seeded++;
+    // Check every scenario before the baseline run: an unreadable file would
+    // run as a deployment without ROV, and files sharing a stem would write
+    // the same output
+    std::unordered_map<std::string, std::string> stems;
+    for (const auto& scenario : scenarios) {
+        if (!std::ifstream(scenario).is_open()) {
+            std::cerr << "Error: Could not open ROV ASNs file: " << scenario << "\n";
+            return 1;
+        }
+        auto [it, inserted] = stems.emplace(std::filesystem::path(scenario).stem().string(), scenario);
+        if (!inserted) {
+            std::cerr << "Error: ROV scenarios " << it->second << " and " << scenario
+                      << " would both write " << getScenarioOutputFile(config.output_file, it->first)
+                      << "\n";
+            return 1;
+        }
     }
 
-    std::cout << "  Seeded: " << seeded << " announcements\n";
-    if (skipped > 0) {
-        std::cout << "  Skipped: " << skipped << " (ASN not in graph)\n";
+    std::unordered_set<std::string> prefixes;
+    std::unordered_set<std::string> invalid_prefixes;
+    for (const auto& ann : announcements) {
+        prefixes.insert(ann.prefix);
+        if (ann.rov_invalid) {
+            invalid_prefixes.insert(ann.prefix);
+        }
     }
+    std::vector<InputAnnouncement> affected;
+    std::vector<InputAnnouncement> unaffected;
+    for (const auto& ann : announcements) {
+        (invalid_prefixes.count(ann.prefix) ? affected : unaffected).push_back(ann);
+    }
+    std::cout << "  ROV scenarios: " << scenarios.size() << "; " << invalid_prefixes.size()
+              << " of " << prefixes.size() << " prefixes have a ROV-invalid origin\n";
 
-    // Run BGPy-style hierarchical propagation until convergence
-    std::cout << "  Running hierarchical propagation...\n";
-    const auto& ranks = graph.getPropagationRanks();
-    int round = 0;
-    bool changed = true;
-
-    while (changed) {
-        round++;
-        changed = false;
-
-        // Phase 1: Propagate to providers (bottom-up through ranks)
-        for (size_t i = 0; i < ranks.size(); i++) {
-            // Process incoming from lower ranks (customers)
-            if (i > 0) {
-                for (AS* as_ptr : ranks[i]) {
-                    if (as_ptr->processIncomingQueue()) {
-                        changed = true;
-                    }
-                }
-            }
-            // Propagate ONLY to providers (higher ranks)
-            for (AS* as_ptr : ranks[i]) {
-                as_ptr->propagateToProviders();
+    // The engines snapshot the ROV flags, so every ROV set gets its own runner
+    auto simulate = [&](const std::vector<InputAnnouncement>& batch, const std::string& filename) {
+        graph.clearRoutingTables();
+        PropagationOptions options = graph.detectPropagationOptions();
+        options.tie_break = config.tie_break;
+        PropagationRunner runner(graph, config.engine, options, config.num_threads, config.block_size);
+        runner.run(batch);
+        return CSVOutput::writeRoutingTable(graph, filename, aliases);
+    };
+
+    std::string unaffected_part = config.output_file + ".unaffected";
+    std::string affected_part = config.output_file + ".affected";
+    auto cleanup = [&]() {
+        std::remove(unaffected_part.c_str());
+        std::remove(affected_part.c_str());
+    };
+
+    auto start = Clock::now();
+    if (!simulate(unaffected, unaffected_part) || !simulate(affected, affected_part) ||
+        !CSVOutput::mergeRoutingTables({unaffected_part, affected_part}, config.output_file)) {
+        std::cerr << "Error: Failed to write baseline output\n";
+        cleanup();
+        return 1;
+    }
+    std::cout << "  Baseline: " << prefixes.size() << " prefixes in " << secondsSince(start) << "s\n";
+    std::cout << "  ✓ Propagation complete\n\n";
+
+    std::cout << "[5/5] Running ROV Scenarios...\n";
+    std::cout << "  Baseline output: " << config.output_file << "\n";
+    for (const auto& scenario : scenarios) {
+        auto rov_asns = CSVInput::parseROVASNs(scenario);
+        for (const auto& [asn, as_ptr] : graph.getAllASes()) {
+            as_ptr->setDropInvalid(false);
+        }
+        for (uint32_t asn : rov_asns) {
+            if (AS* as = graph.getAS(asn)) {
+                as->setDropInvalid(true);
             }
         }
 
-        // Phase 2: Propagate to peers (all ranks)
-        for (const auto& rank : ranks) {
-            for (AS* as_ptr : rank) {
-                as_ptr->propagateToPeers();
-            }
+        auto scenario_start = Clock::now();
+        std::string output = getScenarioOutputFile(
+            config.output_file, std::filesystem::path(scenario).stem().string());
+        if (!simulate(affected, affected_part) ||
+            !CSVOutput::mergeRoutingTables({unaffected_part, affected_part}, output)) {
+            std::cerr << "Error: Failed to write scenario output " << output << "\n";
+            cleanup();
+            return 1;
         }
-        for (const auto& rank : ranks) {
-            for (AS* as_ptr : rank) {
-                if (as_ptr->processIncomingQueue()) {
-                    changed = true;
-                }
-            }
+        std::cout << "  " << scenario << ": " << rov_asns.size() << " ROV ASNs, "
+                  << invalid_prefixes.size() << " prefixes re-simulated in "
+                  << secondsSince(scenario_start) << "s -> " << output << "\n";
+    }
+    cleanup();
+    std::cout << "  Peak memory: " << peakMemoryMB() << " MB\n";
+    std::cout << "  End-to-end: " << secondsSince(start) << "s\n";
+    std::cout << "  ✓ ROV scenarios complete\n\n";
+    return 0;
+}
+
+// Scenario manifest mode: the graph is loaded once and shared read-only by
+// scenarios running concurrently, each with its own RIBs and output file
+int runScenarios(const SimulationConfig& config, const std::string& manifest) {
+    auto scenarios = ScenarioRunner::parseManifest(manifest);
+    if (scenarios.empty()) {
+        std::cerr << "Error: No scenarios loaded\n";
+        return 1;
+    }
+    for (auto& scenario : scenarios) {
+        scenario.output_file = getScenarioOutputFile(config.output_file, scenario.name);
+    }
+    if (!ScenarioRunner::validate(scenarios)) {
+        return 1;
+    }
+
+    auto start = Clock::now();
+    ASGraph graph;
+    int status = loadGraph(config.caida_file, graph);
+    if (status != 0) {
+        return status;
+    }
+
+    std::cout << "Running " << scenarios.size() << " Scenarios...\n";
+    ScenarioRunner runner(graph, config.num_threads);
+    bool ok = runner.run(scenarios);
+
+    for (size_t i = 0; i < scenarios.size(); i++) {
+        const auto& result = runner.getResults()[i];
+        std::cout << "  " << scenarios[i].name << ": ";
+        if (result.ok) {
+            std::cout << result.prefixes << " prefixes, " << result.seeded << " seeded, "
+                      << result.seconds << "s -> " << scenarios[i].output_file << "\n";
+        } else {
+            std::cout << "failed\n";
         }
+    }
+    if (config.num_threads > 1) {
+        std::cout << runner.getExecutor().getSummary();
+    }
+    std::cout << "  Peak memory: " << peakMemoryMB() << " MB\n";
+    std::cout << "  End-to-end: " << secondsSince(start) << "s\n";
+    if (!ok) {
+        std::cerr << "Error: Some scenarios failed\n";
+        return 1;
+    }
+    std::cout << "  ✓ Scenarios complete\n\n";
+    return 0;
+}
 
-        // Phase 3: Propagate to customers (top-down through ranks)
-        for (int i = ranks.size() - 1; i >= 0; i--) {
-            // Process incoming from higher ranks (providers)
-            if (i < (int)ranks.size() - 1) {
-                for (AS* as_ptr : ranks[i]) {
-                    if (as_ptr->processIncomingQueue()) {
-                        changed = true;
-                    }
-                }
-            }
-            // Propagate ONLY to customers (lower ranks)
-            for (AS* as_ptr : ranks[i]) {
-                as_ptr->propagateToCustomers();
-            }
+// Monte Carlo ROV-adoption mode: hijack outcomes per adoption percentage,
+// aggregated over random adopter sets, instead of RIBs
+int runAdoptionSweep(const SimulationConfig& config) {
+    auto start = Clock::now();
+    ASGraph graph;
+    int status = loadGraph(config.caida_file, graph);
+    if (status != 0) {
+        return status;
+    }
+
+    auto announcements = CSVInput::parseAnnouncements(config.announcements_file);
+    if (announcements.empty()) {
+        std::cerr << "Error: No announcements loaded\n";
+        return 1;
+    }
+
+    std::cout << "Running ROV Adoption Sweep...\n";
+    AdoptionSweep sweep(graph, announcements, config.num_threads);
+    if (sweep.getContestedPrefixCount() == 0) {
+        std::cerr << "Error: No prefix has a ROV-invalid origin\n";
+        return 1;
+    }
+    std::cout << "  " << sweep.getContestedPrefixCount() << " contested prefixes, "
+              << config.sweep_percents.size() << " adoption levels x " << config.sweep_trials
+              << " trials (" << (config.sweep_cone_weighted ? "cone-weighted" : "uniform")
+              << ", seed " << config.sweep_seed << ")\n";
+
+    sweep.run(config.sweep_percents, config.sweep_trials, config.sweep_seed,
+              config.sweep_cone_weighted ? AdoptionSweep::Weighting::CUSTOMER_CONE
+                                         : AdoptionSweep::Weighting::UNIFORM);
+    std::cout << "  Finished in " << sweep.getExecutor().getWallSeconds() << "s\n";
+    if (config.num_threads > 1) {
+        std::cout << sweep.getExecutor().getSummary();
+    }
+
+    if (!sweep.writeCSV(config.sweep_output)) {
+        return 1;
+    }
+    std::cout << "  Sweep file: " << config.sweep_output << "\n";
+    std::cout << "  End-to-end: " << secondsSince(start) << "s\n";
+    std::cout << "  ✓ Adoption sweep complete\n\n";
+    return 0;
+}
+
+// Data-plane traceback over the converged RIBs: where packets to each probe
+// address end up from every AS
+int runTraceback(const SimulationConfig& config, const ASGraph& graph,
+                 const std::vector<InputAnnouncement>& announcements, const PrefixAliases& aliases) {
+    std::cout << "Tracing Data-Plane Forwarding...\n";
+    auto start = Clock::now();
+    Traceback traceback(graph, announcements, aliases);
+    auto probes = config.probes.empty() ? traceback.getDefaultProbes() : config.probes;
+
+    std::ofstream file(config.traceback_file);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << config.traceback_file << "\n";
+        return 1;
+    }
+    file << "probe,asn,prefix,outcome\n";
+    for (const auto& probe : probes) {
+        if (!traceback.trace(probe)) {
+            std::cerr << "Warning: Skipping invalid probe address " << probe << "\n";
+            continue;
         }
+        traceback.writeRows(file, probe);
+        std::cout << "  " << probe << ": "
+                  << traceback.getCount(Traceback::Outcome::ORIGIN) << " reach the origin, "
+                  << traceback.getCount(Traceback::Outcome::ATTACKER) << " the attacker, "
+                  << traceback.getCount(Traceback::Outcome::DISCONNECTED) << " disconnected ("
+                  << traceback.getLoopCount() << " in forwarding loops)\n";
     }
+    std::cout << "  Traced " << probes.size() << " probes in " << secondsSince(start) << "s\n";
+    std::cout << "  Traceback file: " << config.traceback_file << "\n";
+    std::cout << "  ✓ Traceback complete\n\n";
+    return 0;
+}
 
-    std::cout << "  Converged after " << round << " rounds\n";
+// ROV placement mode: converge once, then add adopters greedily by the
+// number of routes their ROV deployment protects
+int runROVPlacement(const SimulationConfig& config, const ASGraph& graph,
+                    const std::vector<InputAnnouncement>& announcements) {
+    std::cout << "  Running incremental route solver...\n";
+    auto start = Clock::now();
+    IncrementalSimulation simulation(graph, announcements, config.num_threads);
+    std::cout << "  Converged " << simulation.getPrefixCount() << " prefixes in "
+              << secondsSince(start) << "s\n";
     std::cout << "  ✓ Propagation complete\n\n";
-    
-    // Step 5: Export routing tables to CSV
-    std::cout << "[5/5] Exporting Routing Tables...\n";
-    
-    if (!CSVOutput::writeRoutingTable(graph, output_file)) {
-        std::cerr << "Error: Failed to write output CSV\n";
+
+    std::cout << "[5/5] Placing ROV Adopters...\n";
+    auto candidates = simulation.getInvalidRouteHolders();
+    std::cout << "  " << simulation.countInvalidRoutes() << " routes lead to an invalid origin; "
+              << candidates.size() << " candidate ASes hold one\n";
+
+    auto place_start = Clock::now();
+    ROVPlacement placement(simulation, config.num_threads);
+    auto picks = placement.run(candidates, config.placement_k);
+    for (size_t i = 0; i < picks.size() && i < 10; i++) {
+        std::cout << "  " << i + 1 << ". AS" << picks[i].asn << ": " << picks[i].gain
+                  << " routes protected, " << picks[i].invalid_after << " still invalid\n";
+    }
+    std::cout << "  Picked " << picks.size() << " adopters in " << secondsSince(place_start) << "s with "
+              << placement.getEvaluationCount() << " gain evaluations (greedy without lazy "
+              << "evaluation: up to " << candidates.size() * picks.size() << ")\n";
+
+    if (!ROVPlacement::writeCSV(config.placement_output, picks)) {
         return 1;
     }
+    std::cout << "  Placement file: " << config.placement_output << "\n";
+    std::cout << "  ✓ ROV placement complete\n\n";
+    return 0;
+}
+
+// Link-failure mode: converge once, then fail the busiest links one at a
+// time against that baseline
+int runLinkSweep(const SimulationConfig& config, const ASGraph& graph,
+                 const std::vector<InputAnnouncement>& announcements) {
+    std::cout << "  Running incremental route solver...\n";
+    auto start = Clock::now();
+    IncrementalSimulation simulation(graph, announcements, config.num_threads);
+    std::cout << "  Converged " << simulation.getPrefixCount() << " prefixes in "
+              << secondsSince(start) << "s\n";
+    std::cout << "  ✓ Propagation complete\n\n";
+
+    std::cout << "[5/5] Failing Links...\n";
+    auto sweep_start = Clock::now();
+    LinkFailureSweep sweep(simulation, config.num_threads);
+    auto links = sweep.selectLinks(config.link_sweep_k);
+    std::cout << "  Selected " << links.size() << " links by transit load in "
+              << secondsSince(sweep_start) << "s\n";
+    links = sweep.run(std::move(links));
+    for (size_t i = 0; i < links.size() && i < 10; i++) {
+        std::cout << "  " << i + 1 << ". AS" << links[i].a << (links[i].peer ? " -- AS" : " -> AS")
+                  << links[i].b << ": " << links[i].changed << " routes change (load "
+                  << links[i].load << ")\n";
+    }
+    std::cout << "  Evaluated " << links.size() << " failures in " << secondsSince(sweep_start) << "s\n";
+
+    if (!LinkFailureSweep::writeCSV(config.link_sweep_output, links)) {
+        return 1;
+    }
+    std::cout << "  Criticality file: " << config.link_sweep_output << "\n";
+    std::cout << "  ✓ Link sweep complete\n\n";
+    return 0;
+}
+
+// Route-leak mode: converge the victim prefix once, then evaluate each
+// leaker incrementally against that baseline
+int runRouteLeaks(const SimulationConfig& config, const ASGraph& graph,
+                  const std::vector<InputAnnouncement>& announcements) {
+    std::vector<InputAnnouncement> victim;
+    for (const auto& ann : announcements) {
+        if (ann.prefix == config.leak_prefix) {
+            victim.push_back(ann);
+        }
+    }
+    if (victim.empty()) {
+        std::cerr << "Error: No announcement for --route-leaks prefix " << config.leak_prefix << std::endl;
+        return 1;
+    }
+
+    std::cout << "  Running incremental route solver...\n";
+    auto start = Clock::now();
+    IncrementalSimulation simulation(graph, victim, config.num_threads);
+    std::cout << "  Converged " << config.leak_prefix << " in " << secondsSince(start) << "s\n";
+    std::cout << "  ✓ Propagation complete\n\n";
+
+    std::cout << "[5/5] Evaluating Route Leaks...\n";
+    std::vector<uint32_t> leakers = config.leakers_file.empty()
+        ? simulation.getLeakCandidates(config.leak_prefix)
+        : CSVInput::parseASNList(config.leakers_file, "leaker ASNs");
+    if (config.leak_sample > 0 && config.leak_sample < leakers.size()) {
+        std::mt19937_64 rng(config.sweep_seed);
+        std::shuffle(leakers.begin(), leakers.end(), rng);
+        leakers.resize(config.leak_sample);
+        std::sort(leakers.begin(), leakers.end());
+    }
+
+    auto leak_start = Clock::now();
+    RouteLeaks leaks(simulation, config.num_threads);
+    auto results = leaks.run(config.leak_prefix, leakers);
+    size_t others = graph.size() > 1 ? graph.size() - 1 : 1;
+    for (size_t i = 0; i < results.size() && i < 10; i++) {
+        std::cout << "  " << i + 1 << ". AS" << results[i].leaker << ": " << results[i].adopters
+                  << " ASes adopt the leak ("
+                  << 100.0 * static_cast<double>(results[i].adopters) / others << "%)\n";
+    }
+    std::cout << "  Evaluated " << results.size() << " leakers in " << secondsSince(leak_start) << "s\n";
+
+    if (!RouteLeaks::writeCSV(config.leak_output, config.leak_prefix, results, graph.size())) {
+        return 1;
+    }
+    std::cout << "  Leak file: " << config.leak_output << "\n";
+    std::cout << "  ✓ Route leaks complete\n\n";
+    return 0;
+}
+
+// Steps 1-2: the graph (and --cones file), ROV adopters and leaking ASes of
+// a run. Returns 0, or the exit code on failure.
+int loadTopology(const SimulationConfig& config, ASGraph& graph) {
+    int status = loadGraph(config.caida_file, graph);
+    if (status != 0) {
+        return status;
+    }
+    if (!config.cones_file.empty()) {
+        if (!CSVOutput::writeCustomerCones(graph, config.cones_file)) {
+            return 1;
+        }
+        std::cout << "  Customer cones file: " << config.cones_file << "\n\n";
+    }
+
+    // Step 2: Load ROV ASNs (optional)
+    std::cout << "[2/5] Loading ROV ASNs...\n";
+    std::unordered_set<uint32_t> rov_asns_set;
+
+    // Set ROV validator for ALL ASes so they can check ROV state
+    for (const auto& [asn, as_ptr] : graph.getAllASes()) {
+        as_ptr->setROVValidator(&graph.getROVValidator());
+    }
+
+    if (!config.rov_asns_file.empty()) {
+        auto rov_asns = CSVInput::parseROVASNs(config.rov_asns_file);
+        rov_asns_set.insert(rov_asns.begin(), rov_asns.end());
+        std::cout << "  Loaded " << rov_asns_set.size() << " ROV ASNs\n";
+
+        // Enable ROV filtering ONLY on ROV ASes - drop INVALID routes
+        for (uint32_t asn : rov_asns_set) {
+            AS* as = graph.getAS(asn);
+            if (as) {
+                as->setDropInvalid(true);
+            }
+        }
+    } else {
+        std::cout << "  No ROV ASNs file provided (optional)\n";
+    }
+
+    // Leaking ASes export against valley-free (Policy::shouldExport)
+    if (!config.leak_asns_file.empty()) {
+        if (!std::ifstream(config.leak_asns_file).is_open()) {
+            std::cerr << "Error: Could not open leaking ASNs file: " << config.leak_asns_file << "\n";
+            return 1;
+        }
+        auto leaking = CSVInput::parseASNList(config.leak_asns_file, "leaking ASNs");
+        size_t leakers = graph.setLeakingASes(leaking);
+        std::cout << "  Leaking ASes: " << leakers << "\n";
+    }
+    std::cout << "  ✓ ROV configuration complete\n\n";
+    return 0;
+}
+
+// Add a ROA for every valid announcement
+void addROAs(ASGraph& graph, const std::vector<InputAnnouncement>& announcements) {
+    for (const auto& input_ann : announcements) {
+        if (!input_ann.rov_invalid) {
+            graph.getROVValidator().addROA(input_ann.prefix, input_ann.asn);
+        }
+    }
+}
+
+// When steps 1-2 started and how long loading and parsing took, for the
+// Stages line
+struct LoadTimes {
+    Clock::time_point start = Clock::now();
+    double load_seconds = 0;
+    double parse_seconds = 0;
+};
+
+// Steps 3-5 over a topology from loadTopology(): seed, propagate and write
+// the RIBs of announcements. The ROAs come from announcements, unless
+// config names the whole run's (roa_file), which the caller has added.
+int simulateRun(const SimulationConfig& config, ASGraph& graph,
+                std::vector<InputAnnouncement> announcements, const LoadTimes& times) {
+    auto start = times.start;
+    double load_seconds = times.load_seconds;
+    double parse_seconds = times.parse_seconds;
+
+    // Step 3: Load and seed announcements
+    std::cout << "[3/5] Loading Announcements...\n";
+    if (announcements.empty()) {
+        std::cerr << "Error: No announcements loaded\n";
+        return 1;
+    }
+    
+    std::cout << "  Loaded " << announcements.size() << " announcements\n";
+    std::cout << "  ✓ Announcements parsed\n\n";
+    
+    // Step 4: Seed announcements into the graph
+    std::cout << "[4/5] Seeding Announcements and Simulating Propagation...\n";
+
+    // First, create ROAs for valid announcements
+    if (config.roa_file.empty()) {
+        addROAs(graph, announcements);
+    }
+
+    // Prefixes with the same origins and ROV states propagate identically:
+    // simulate one per class and fan the routes out when writing the RIBs
+    PrefixAliases aliases;
+    if (config.prefix_classes) {
+        PrefixClasses classes = PrefixClasses::group(announcements, graph.getROVValidator());
+        std::cout << "  Prefix classes: " << classes.getClassCount() << " for "
+                  << classes.num_prefixes << " prefixes\n";
+        announcements = std::move(classes.announcements);
+        aliases = std::move(classes.aliases);
+    }
+
+    std::unordered_set<uint32_t> origins;
+    for (const auto& input_ann : announcements) {
+        origins.insert(input_ann.asn);
+    }
+
+    if (config.compact) {
+        // Equivalent ASes only lose ties under the lowest-ASN rule
+        size_t derived = graph.compactTopology(origins, config.tie_break == TieBreak::LOWEST_NEIGHBOR_ASN);
+        std::cout << "  Compaction: " << derived << " of " << graph.size()
+                  << " ASes derived from a provider or equivalent AS\n";
+    }
+
+    // Demand-driven mode: prune every AS that cannot influence the vantage points
+    std::vector<uint32_t> vantage_asns;
+    if (!config.vantage_file.empty()) {
+        vantage_asns = CSVInput::parseASNList(config.vantage_file, "vantage ASNs");
+        if (vantage_asns.empty()) {
+            std::cerr << "Error: No vantage ASNs loaded\n";
+            return 1;
+        }
+        size_t kept = graph.restrictToVantagePoints(vantage_asns, origins);
+        std::cout << "  Vantage points: " << vantage_asns.size() << ", propagating over "
+                  << kept << " of " << graph.size() << " ASes\n";
+    }
+
+    // Pick the propagation kernel once: CSV announcements carry no
+    // communities, and ROV checks are only compiled in if some AS filters
+    PropagationOptions options = graph.detectPropagationOptions();
+    options.tie_break = config.tie_break;
+    std::cout << "  Kernel: ROV " << (options.rov ? "on" : "off")
+              << ", communities " << (options.communities ? "on" : "off")
+              << ", tie-break " << (config.tie_break == TieBreak::OLDEST_PATH ? "oldest" : "lowest-asn")
+              << ", best-path " << BestPathSelector::getKernelName() << "\n";
+
+    if (!config.what_if_file.empty()) {
+        return runWhatIf(config, graph, announcements, aliases);
+    }
+    if (config.what_if_check > 0) {
+        return runWhatIfCheck(config, graph, announcements);
+    }
+    if (config.placement_k > 0) {
+        return runROVPlacement(config, graph, announcements);
+    }
+    if (config.link_sweep) {
+        return runLinkSweep(config, graph, announcements);
+    }
+    if (!config.leak_prefix.empty()) {
+        return runRouteLeaks(config, graph, announcements);
+    }
+    if (!config.rov_scenarios_file.empty()) {
+        return runROVScenarios(config, graph, announcements, aliases);
+    }
+
+    // Backup paths are kept during propagation, so the budget is set before
+    // the runner clones its worker replicas
+    std::ofstream alternates_out;
+    size_t backed_up_routes = 0;
+    if (!config.alternates_file.empty()) {
+        alternates_out.open(config.alternates_file);
+        if (!alternates_out.is_open()) {
+            std::cerr << "Error: Could not open file " << config.alternates_file << std::endl;
+            return 1;
+        }
+        alternates_out << "asn,prefix,rank,as_path\n";
+        graph.keepAlternateRoutes(config.alternates_k, config.alternates_budget_mb * 1024 * 1024);
+        std::cout << "  Backup paths: up to " << config.alternates_k << " per AS and prefix, ";
+        if (config.alternates_budget_mb > 0) {
+            std::cout << config.alternates_budget_mb << " MB budget\n";
+        } else {
+            std::cout << "no memory budget\n";
+        }
+    }
+
+    PropagationRunner runner(graph, config.engine, options, config.num_threads, config.block_size);
+
+    // Batch size: explicit, derived from the memory target, or everything at once
+    auto tasks = PrefixCostModel::buildTasks(announcements);
+    size_t batch_size = config.batch_size;
+    if (batch_size == 0 && config.max_memory_mb > 0) {
+        batch_size = estimateBatchSize(graph, config.max_memory_mb, runner, kWriteBuffers);
+        std::cout << "  Memory target " << config.max_memory_mb << " MB: batches of up to "
+                  << batch_size << " prefixes\n";
+    }
+    if (batch_size == 0 || batch_size > tasks.size()) {
+        batch_size = std::max<size_t>(tasks.size(), 1);
+    }
+    size_t num_batches = (tasks.size() + batch_size - 1) / batch_size;
+
+    std::cout << "  Running " << runner.describe() << "...\n";
+
+    RouteSummary summary;
+    bool summarize = !config.summary_file.empty();
+    TransitLoad transit_load(config.num_threads);
+    auto write_ribs = [&](const ASGraph& ribs, const std::string& filename, size_t batch) {
+        if (!config.transit_load_file.empty()) {
+            size_t first = batch * batch_size;
+            size_t count = std::min(batch_size, tasks.size() - first);
+            transit_load.add(ribs, tasks.data() + first, count, aliases);
+        }
+        if (alternates_out.is_open()) {
+            backed_up_routes += CSVOutput::writeAlternateRoutes(alternates_out, ribs, aliases, vantage_asns);
+        }
+        if (summarize) {
+            // Counted, not written: the summary replaces the RIB dump
+            summary.add(ribs, vantage_asns);
+            return true;
+        }
+        return vantage_asns.empty()
+            ? CSVOutput::writeRoutingTable(ribs, filename, aliases)
+            : CSVOutput::writeRoutingTable(ribs, filename, aliases, vantage_asns);
+    };
+
+    // Routes currently held for the written ASes, fanned out to aliases
+    auto count_routes = [&](const ASGraph& ribs) {
+        auto count_table = [&aliases](const std::unordered_map<std::string, Announcement>& table) {
+            size_t count = 0;
+            for (const auto& [prefix, ann] : table) {
+                auto alias = aliases.find(prefix);
+                count += alias != aliases.end() ? alias->second.size() : 1;
+            }
+            return count;
+        };
+        size_t count = 0;
+        for (const auto& [asn, as] : ribs.getAllASes()) {
+            if (!vantage_asns.empty() &&
+                std::find(vantage_asns.begin(), vantage_asns.end(), asn) == vantage_asns.end()) {
+                continue;
+            }
+            count += ribs.isDerived(asn) ? count_table(ribs.getRoutingTable(asn))
+                                         : count_table(as->getRoutingTable());
+        }
+        return count;
+    };
+
+    // Writer stage: a finished batch's RIBs are swapped into a free buffer
+    // (a topology clone) and written on another thread while the next batch
+    // propagates. Buffers circulate through two bounded queues.
+    struct FinishedBatch {
+        ASGraph* ribs;
+        size_t index;
+        size_t prefixes;
+    };
+    BoundedQueue<ASGraph*> free_buffers(kWriteBuffers);
+    BoundedQueue<FinishedBatch> finished(kWriteBuffers);
+    std::vector<std::unique_ptr<ASGraph>> buffers;
+    std::vector<std::string> parts;
+    auto remove_parts = [&parts]() {
+        for (const auto& part : parts) {
+            std::remove(part.c_str());
+        }
+    };
+    std::thread writer;
+    bool write_failed = false;
+    size_t total_routes = 0;
+    double write_seconds = 0;
+
+    if (num_batches > 1) {
+        for (size_t b = 0; b < num_batches; b++) {
+            parts.push_back(config.output_file + ".batch" + std::to_string(b));
+        }
+        for (size_t i = 0; i < kWriteBuffers; i++) {
+            buffers.push_back(graph.cloneTopology());
+            free_buffers.push(buffers.back().get());
+        }
+        writer = std::thread([&]() {
+            FinishedBatch batch;
+            while (finished.pop(batch)) {
+                auto write_start = Clock::now();
+                write_failed |= !write_ribs(*batch.ribs, parts[batch.index], batch.index);
+                size_t batch_routes = count_routes(*batch.ribs);
+                total_routes += batch_routes;
+                batch.ribs->clearRoutingTables();
+                write_seconds += secondsSince(write_start);
+                std::cout << "  Batch " << batch.index + 1 << "/" << num_batches << ": "
+                          << batch.prefixes << " prefixes, " << batch_routes << " routes\n";
+                free_buffers.push(batch.ribs);
+            }
+        });
+    }
+
+    size_t seeded = 0;
+    double simulate_seconds = 0;
+    for (size_t b = 0; b < num_batches; b++) {
+        size_t first = b * batch_size;
+        size_t last = std::min(first + batch_size, tasks.size());
+        std::vector<InputAnnouncement> batch;
+        for (size_t t = first; t < last; t++) {
+            batch.insert(batch.end(), tasks[t].announcements.begin(), tasks[t].announcements.end());
+        }
+
+        auto simulate_start = Clock::now();
+        seeded += runner.run(batch);
+        simulate_seconds += secondsSince(simulate_start);
+        if (num_batches == 1) {
+            break;  // Written directly in step 5
+        }
+
+        // Hand the routes to the writer; the graph gets the buffer's empty tables
+        ASGraph* buffer = nullptr;
+        free_buffers.pop(buffer);
+        graph.swapRoutingTables(*buffer);
+        finished.push(FinishedBatch{buffer, b, last - first});
+    }
+
+    if (writer.joinable()) {
+        finished.close();
+        writer.join();
+        if (write_failed) {
+            std::cerr << "Error: Failed to write batch output\n";
+            remove_parts();
+            return 1;
+        }
+    }
+
+    size_t skipped = announcements.size() - seeded;
+    std::cout << "  Seeded: " << seeded << " announcements\n";
+    if (skipped > 0) {
+        std::cout << "  Skipped: " << skipped << " (ASN not in graph)\n";
+    }
+    if (runner.getMaxRounds() > 0) {
+        bool several = config.num_threads > 1 || num_batches > 1;
+        std::cout << "  Converged after " << (several ? "at most " : "")
+                  << runner.getMaxRounds() << " rounds\n";
+    }
+    if (config.num_threads > 1) {
+        std::cout << runner.getExecutor().getSummary();
+    }
+
+    std::cout << "  ✓ Propagation complete\n\n";
     
-    // Count total routes
-    int total_routes = 0;
-    for (const auto& [asn, as] : graph.getAllASes()) {
-        total_routes += as->getRoutingTable().size();
+    // Step 5: Export routing tables to CSV
+    std::cout << "[5/5] Exporting Routing Tables...\n";
+
+    auto export_start = Clock::now();
+    if (parts.empty()) {
+        if (!write_ribs(graph, config.output_file, 0)) {
+            std::cerr << "Error: Failed to write output CSV\n";
+            return 1;
+        }
+        total_routes = count_routes(graph);
+        write_seconds = secondsSince(export_start);
+    } else if (!summarize) {
+        // Batches are sorted by ASN internally; merge them into one ordered file
+        bool merged = CSVOutput::mergeRoutingTables(parts, config.output_file);
+        remove_parts();
+        if (!merged) {
+            std::cerr << "Error: Failed to merge batch outputs\n";
+            return 1;
+        }
+        std::cout << "  Merged " << parts.size() << " batch files\n";
+    }
+    if (summarize && !summary.writeCSV(config.summary_file, aliases)) {
+        std::cerr << "Error: Failed to write summary CSV\n";
+        return 1;
+    }
+    if (!config.transit_load_file.empty()) {
+        if (!transit_load.writeCSV(config.transit_load_file)) {
+            std::cerr << "Error: Failed to write transit load CSV\n";
+            return 1;
+        }
+        std::cout << "  Transit load file: " << config.transit_load_file << "\n";
+    }
+    if (alternates_out.is_open()) {
+        alternates_out.close();
+        if (!alternates_out) {
+            std::cerr << "Error: Failed to write alternates CSV\n";
+            return 1;
+        }
+        std::cout << "  Alternates file: " << config.alternates_file << " (" << backed_up_routes
+                  << " routes with a backup)\n";
+        size_t refused = graph.getAlternateBudget()->refused_routes;
+        if (refused > 0) {
+            std::cout << "  Warning: backup-path budget reached; " << refused
+                      << " received routes were not kept\n";
+        }
     }
     
     std::cout << "  Total routes: " << total_routes << "\n";
-    std::cout << "  Output file: " << output_file << "\n";
+    std::cout << "  Output file: " << (summarize ? config.summary_file : config.output_file) << "\n";
+    std::cout << "  Peak memory: " << peakMemoryMB() << " MB\n";
+
+    // Stages that overlap add up to more than the wall time; the one
+    // closest to it is the bottleneck
+    std::ostringstream stages;
+    stages.precision(2);
+    stages << std::fixed << "  Stages: load " << load_seconds << "s, parse " << parse_seconds
+           << "s (overlapped), simulate " << simulate_seconds << "s, write " << write_seconds << "s";
+    if (!parts.empty()) {
+        stages << " (overlapped), " << (summarize ? "summary " : "merge ")
+               << secondsSince(export_start) << "s\n"
+               << "  Batch queue: " << finished.describe() << "; simulation waited "
+               << free_buffers.getPopWaitSeconds() << "s for the writer, writer idle "
+               << finished.getPopWaitSeconds() << "s";
+    }
+    stages << "\n  End-to-end: " << secondsSince(start) << "s\n";
+    std::cout << stages.str();
     std::cout << "  ✓ Routing tables exported\n\n";
-    
+
+    if (!config.traceback_file.empty()) {
+        return runTraceback(config, graph, announcements, aliases);
+    }
+    return 0;
+}
+
+// Steps 1-5: load, seed, propagate and write one run's RIBs
+int runSimulation(const SimulationConfig& config) {
+    // Announcements are parsed while the graph loads; step 3 waits for them
+    LoadTimes times;
+    auto parsed = std::async(std::launch::async, [&config, &times]() {
+        auto announcements = CSVInput::parseAnnouncements(config.announcements_file);
+        times.parse_seconds = secondsSince(times.start);
+        return announcements;
+    });
+
+    ASGraph graph;
+    int status = loadTopology(config, graph);
+    if (status != 0) {
+        return status;
+    }
+    times.load_seconds = secondsSince(times.start);
+    return simulateRun(config, graph, parsed.get(), times);
+}
+
+// Claim and simulate shards until none are pending. A failed shard goes
+// back to pending/, so the coordinator never merges a partial result. The
+// graph, ROV adopters and the whole run's ROAs are loaded into topology for
+// the first shard and reused for every later one, across calls too.
+int runShardWorker(const SimulationConfig& config, ShardDirectory& shards,
+                   const std::string& worker_id, std::unique_ptr<ASGraph>& topology) {
+    // Inputs and the options that change the RIBs come from the manifest
+    SimulationConfig run = config;
+    run.caida_file = shards.getRelationshipsFile();
+    run.rov_asns_file = shards.getROVASNsFile();
+    run.roa_file = shards.getAnnouncementsFile();
+    run.vantage_file = shards.getVantageFile();
+    run.tie_break = shards.getTieBreak();
+    if (run.engine != "inbox" && run.tie_break != TieBreak::LOWEST_NEIGHBOR_ASN) {
+        std::cerr << "Error: --engine " << run.engine << " only supports --tie-break lowest-asn, "
+                  << "but the shard manifest uses oldest\n";
+        return 1;
+    }
+
+    auto simulate = [&](const SimulationConfig& shard) {
+        LoadTimes times;
+        if (topology) {
+            topology->restoreTopology();  // Drop the previous shard's routes and pruning
+        } else {
+            auto graph = std::make_unique<ASGraph>();
+            int status = loadTopology(shard, *graph);
+            if (status != 0) {
+                return status;
+            }
+            addROAs(*graph, CSVInput::parseAnnouncements(shard.roa_file));
+            topology = std::move(graph);
+        }
+        times.load_seconds = secondsSince(times.start);
+        auto announcements = CSVInput::parseAnnouncements(shard.announcements_file);
+        times.parse_seconds = secondsSince(times.start) - times.load_seconds;
+        return simulateRun(shard, *topology, std::move(announcements), times);
+    };
+
+    size_t done = 0;
+    for (std::string claimed = shards.claim(worker_id); !claimed.empty();
+         claimed = shards.claim(worker_id)) {
+        std::cout << "── Shard " << claimed << " (worker " << worker_id << ") ──\n\n";
+
+        SimulationConfig shard = run;
+        shard.announcements_file = claimed;
+        shard.output_file = shards.getPartialFile(claimed);
+
+        int status = 0;
+        {
+            ShardLease lease(shards, claimed, kLeaseRenewSeconds);
+            status = simulate(shard);
+        }
+        if (status != 0) {
+            shards.release(claimed);
+            return status;
+        }
+        if (!shards.complete(claimed)) {
+            std::cerr << "Error: Could not publish the RIBs of " << claimed << "\n";
+            shards.release(claimed);
+            return 1;
+        }
+        done++;
+    }
+
+    std::cout << "Worker " << worker_id << " finished " << done << " shards\n\n";
+    return 0;
+}
+
+// Split the run into shards, work on them alongside any other workers, then
+// merge every shard's RIBs into the output file
+int runCoordinator(const SimulationConfig& config, const std::string& shard_dir,
+                   size_t num_shards, const std::string& worker_id, size_t timeout_seconds) {
+    std::cout << "Sharding " << config.announcements_file << " into " << shard_dir << "...\n";
+    auto announcements = CSVInput::parseAnnouncements(config.announcements_file);
+    if (announcements.empty()) {
+        std::cerr << "Error: No announcements loaded\n";
+        return 1;
+    }
+
+    ShardDirectory shards(shard_dir);
+    if (!shards.create(config.caida_file, config.announcements_file, config.rov_asns_file,
+                       config.vantage_file, config.tie_break, announcements, num_shards)) {
+        return 1;
+    }
+    std::cout << "  Wrote " << shards.getShardCount() << " shards; start workers with\n"
+              << "  --shard-dir " << shard_dir << " --worker\n\n";
+
+    std::unique_ptr<ASGraph> topology;
+    int status = runShardWorker(config, shards, worker_id, topology);
+    if (status != 0) {
+        return status;
+    }
+
+    // Wait for shards other workers still hold. Claims of workers that
+    // stopped renewing them are taken back and simulated here; without any
+    // shard completing for timeout_seconds, give up. Reclaiming alone is not
+    // progress: a live worker can hold its claim without ever finishing.
+    size_t completed = shards.getCompletedCount();
+    size_t reported = 0;
+    auto last_progress = Clock::now();
+    while (completed < shards.getShardCount()) {
+        if (completed != reported) {
+            std::cout << "  Waiting for workers: " << completed << "/" << shards.getShardCount()
+                      << " shards done\n";
+            reported = completed;
+            last_progress = Clock::now();
+        } else if (secondsSince(last_progress) > static_cast<double>(timeout_seconds)) {
+            std::cerr << "Error: No shard completed in " << timeout_seconds << "s; "
+                      << completed << "/" << shards.getShardCount() << " shards done\n";
+            return 1;
+        }
+        size_t reclaimed = shards.reclaimExpired(kShardLeaseSeconds);
+        if (reclaimed > 0) {
+            std::cout << "  Reclaimed " << reclaimed << " abandoned shard claims\n";
+            status = runShardWorker(config, shards, worker_id, topology);
+            if (status != 0) {
+                return status;
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+        completed = shards.getCompletedCount();
+    }
+
+    std::cout << "Merging " << completed << " shard RIBs...\n";
+    if (!CSVOutput::mergeRoutingTables(shards.getCompletedFiles(), config.output_file)) {
+        std::cerr << "Error: Failed to merge shard outputs\n";
+        return 1;
+    }
+    std::cout << "  Output file: " << config.output_file << "\n";
+    std::cout << "  ✓ Shards merged\n\n";
+    return 0;
+}
+
+// Options that only some run modes use (flags for RunModeOptions::accepted)
+const uint32_t kAnnouncementsOption = 1 << 0;
+const uint32_t kROVASNsOption = 1 << 1;
+const uint32_t kEngineOption = 1 << 2;
+const uint32_t kCompactOption = 1 << 3;
+const uint32_t kVantageOption = 1 << 4;
+const uint32_t kBatchingOption = 1 << 5;       // --batch-size or --max-memory
+const uint32_t kPrefixClassesOption = 1 << 6;  // --no-prefix-classes
+const uint32_t kTieBreakOption = 1 << 7;       // --tie-break other than lowest-asn
+const uint32_t kSummaryOption = 1 << 8;
+const uint32_t kConesOption = 1 << 9;
+const uint32_t kTransitLoadOption = 1 << 10;
+const uint32_t kAlternatesOption = 1 << 11;
+const uint32_t kTracebackOption = 1 << 12;
+const uint32_t kLeakASNsOption = 1 << 13;
+
+const std::pair<uint32_t, const char*> kModeOptionNames[] = {
+    {kAnnouncementsOption, "--announcements"},
+    {kROVASNsOption, "--rov-asns"},
+    {kEngineOption, "--engine"},
+    {kCompactOption, "--compact"},
+    {kVantageOption, "--vantage-asns"},
+    {kBatchingOption, "--batch-size or --max-memory"},
+    {kPrefixClassesOption, "--no-prefix-classes"},
+    {kTieBreakOption, "--tie-break oldest"},
+    {kSummaryOption, "--summary"},
+    {kConesOption, "--cones"},
+    {kTransitLoadOption, "--transit-load"},
+    {kAlternatesOption, "--alternates"},
+    {kTracebackOption, "--traceback"},
+    {kLeakASNsOption, "--leak-asns"},
+};
+
+enum class RunMode {
+    PLAIN, SHARDS, WORKER, REACHABILITY, ROV_SWEEP, SCENARIOS, WHAT_IF, WHAT_IF_CHECK,
+    ROV_SCENARIOS, ROV_PLACEMENT, LINK_SWEEP, ROUTE_LEAKS
+};
+
+// What each mode accepts, in RunMode order
+struct RunModeOptions {
+    const char* name;   // For errors: the option selecting the mode
+    uint32_t accepted;  // Option flags the mode uses; any other is an error
+};
+
+// Shards run plain simulations, but only the coordinator reads the inputs
+// and the RIBs are merged afterwards. The analysis modes converge one
+// baseline with their own solver, and ROV sweeps and scenarios pick their
+// own adopters.
+const uint32_t kAnalysisOptions = kAnnouncementsOption | kROVASNsOption | kPrefixClassesOption | kConesOption;
+const uint32_t kShardOptions = kEngineOption | kCompactOption | kVantageOption | kBatchingOption |
+                               kPrefixClassesOption | kTieBreakOption | kConesOption;
+const RunModeOptions kRunModes[] = {
+    {"a plain run", ~0u},
+    {"--shard-dir", kShardOptions | kAnnouncementsOption | kROVASNsOption},
+    {"--worker", kShardOptions & ~(kVantageOption | kTieBreakOption)},
+    {"--reachability or --path-matrix", kAnnouncementsOption},
+    {"--rov-sweep", kAnnouncementsOption},
+    {"--scenarios", 0},
+    {"--what-if", kAnalysisOptions},
+    {"--what-if-check", kAnalysisOptions},
+    {"--rov-scenarios", kAnalysisOptions | kEngineOption | kTieBreakOption},
+    {"--rov-placement", kAnalysisOptions},
+    {"--link-sweep", kAnalysisOptions},
+    {"--route-leaks", kAnalysisOptions},
+};
+
+static_assert(std::size(kRunModes) == static_cast<size_t>(RunMode::ROUTE_LEAKS) + 1);
+
+const RunModeOptions& getRunMode(RunMode mode) {
+    return kRunModes[static_cast<size_t>(mode)];
+}
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+    std::string reachability_file;
+    std::string reachability_matrix_file;
+    std::string path_matrix_file;
+    std::string path_lookup_file;
+    std::vector<std::string> path_pairs;
+    std::string scenarios_file;
+    bool engine_given = false;
+    std::string shard_dir;
+    size_t num_shards = 0;
+    size_t shard_timeout = kShardTimeoutSeconds;
+    bool worker = false;
+    std::string worker_id = ShardDirectory::defaultWorkerId();
+
+    // Parse command-line arguments
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--relationships" && i + 1 < argc) {
+            config.caida_file = argv[++i];
+        } else if (arg == "--announcements" && i + 1 < argc) {
+            config.announcements_file = argv[++i];
+        } else if (arg == "--rov-asns" && i + 1 < argc) {
+            config.rov_asns_file = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            config.output_file = argv[++i];
+        } else if (arg == "--engine" && i + 1 < argc) {
+            config.engine = argv[++i];
+            engine_given = true;
+        } else if (arg == "--block-size" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.block_size)) {
+                return 1;
+            }
+        } else if (arg == "--batch-size" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.batch_size)) {
+                return 1;
+            }
+        } else if (arg == "--max-memory" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.max_memory_mb)) {
+                return 1;
+            }
+        } else if (arg == "--vantage-asns" && i + 1 < argc) {
+            config.vantage_file = argv[++i];
+        } else if (arg == "--compact") {
+            config.compact = true;
+        } else if (arg == "--no-prefix-classes") {
+            config.prefix_classes = false;
+        } else if (arg == "--reachability" && i + 1 < argc) {
+            reachability_file = argv[++i];
+        } else if (arg == "--reachability-matrix" && i + 1 < argc) {
+            reachability_matrix_file = argv[++i];
+        } else if (arg == "--path-matrix" && i + 1 < argc) {
+            path_matrix_file = argv[++i];
+        } else if (arg == "--path-lookup" && i + 1 < argc) {
+            path_lookup_file = argv[++i];
+        } else if (arg == "--pairs" && i + 1 < argc) {
+            std::istringstream pairs(argv[++i]);
+            std::string pair;
+            while (std::getline(pairs, pair, ',')) {
+                path_pairs.push_back(pair);
+            }
+        } else if (arg == "--what-if" && i + 1 < argc) {
+            config.what_if_file = argv[++i];
+        } else if (arg == "--what-if-output" && i + 1 < argc) {
+            config.what_if_output = argv[++i];
+        } else if (arg == "--what-if-check" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.what_if_check)) {
+                return 1;
+            }
+        } else if (arg == "--rov-sweep" && i + 1 < argc) {
+            std::istringstream percents(argv[++i]);
+            std::string percent;
+            while (std::getline(percents, percent, ',')) {
+                double value = 0;
+                if (!parseNumber(arg, percent, value)) {
+                    return 1;
+                }
+                if (value < 0.0 || value > 100.0) {
+                    std::cerr << "Error: " << arg << " percentages must be between 0 and 100, got '"
+                              << percent << "'\n";
+                    return 1;
+                }
+                config.sweep_percents.push_back(value);
+            }
+        } else if (arg == "--trials" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.sweep_trials)) {
+                return 1;
+            }
+            config.sweep_trials = std::max<size_t>(1, config.sweep_trials);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.sweep_seed)) {
+                return 1;
+            }
+        } else if (arg == "--weight-by-cone") {
+            config.sweep_cone_weighted = true;
+        } else if (arg == "--sweep-output" && i + 1 < argc) {
+            config.sweep_output = argv[++i];
+        } else if (arg == "--rov-placement" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.placement_k)) {
+                return 1;
+            }
+        } else if (arg == "--placement-output" && i + 1 < argc) {
+            config.placement_output = argv[++i];
+        } else if (arg == "--link-sweep" && i + 1 < argc) {
+            std::string k = argv[++i];
+            config.link_sweep = true;
+            config.link_sweep_k = 0;
+            if (k != "all") {
+                if (!parseNumber(arg, k, config.link_sweep_k)) {
+                    return 1;
+                }
+                config.link_sweep_k = std::max<size_t>(1, config.link_sweep_k);
+            }
+        } else if (arg == "--link-sweep-output" && i + 1 < argc) {
+            config.link_sweep_output = argv[++i];
+        } else if (arg == "--route-leaks" && i + 1 < argc) {
+            config.leak_prefix = argv[++i];
+        } else if (arg == "--leakers" && i + 1 < argc) {
+            config.leakers_file = argv[++i];
+        } else if (arg == "--leak-asns" && i + 1 < argc) {
+            config.leak_asns_file = argv[++i];
+        } else if (arg == "--leak-sample" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.leak_sample)) {
+                return 1;
+            }
+        } else if (arg == "--leak-output" && i + 1 < argc) {
+            config.leak_output = argv[++i];
+        } else if (arg == "--summary" && i + 1 < argc) {
+            config.summary_file = argv[++i];
+        } else if (arg == "--cones" && i + 1 < argc) {
+            config.cones_file = argv[++i];
+        } else if (arg == "--transit-load" && i + 1 < argc) {
+            config.transit_load_file = argv[++i];
+        } else if (arg == "--alternates" && i + 1 < argc) {
+            config.alternates_file = argv[++i];
+        } else if (arg == "--alternates-k" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.alternates_k)) {
+                return 1;
+            }
+        } else if (arg == "--alternates-budget-mb" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.alternates_budget_mb)) {
+                return 1;
+            }
+        } else if (arg == "--traceback" && i + 1 < argc) {
+            config.traceback_file = argv[++i];
+        } else if (arg == "--probes" && i + 1 < argc) {
+            std::istringstream probes(argv[++i]);
+            std::string probe;
+            while (std::getline(probes, probe, ',')) {
+                config.probes.push_back(probe);
+            }
+        } else if (arg == "--scenarios" && i + 1 < argc) {
+            scenarios_file = argv[++i];
+        } else if (arg == "--rov-scenarios" && i + 1 < argc) {
+            config.rov_scenarios_file = argv[++i];
+        } else if (arg == "--shard-dir" && i + 1 < argc) {
+            shard_dir = argv[++i];
+        } else if (arg == "--shards" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], num_shards)) {
+                return 1;
+            }
+        } else if (arg == "--shard-timeout" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], shard_timeout)) {
+                return 1;
+            }
+        } else if (arg == "--worker") {
+            worker = true;
+        } else if (arg == "--worker-id" && i + 1 < argc) {
+            worker_id = argv[++i];
+        } else if (arg == "--tie-break" && i + 1 < argc) {
+            std::string rule = argv[++i];
+            if (rule == "lowest-asn") {
+                config.tie_break = TieBreak::LOWEST_NEIGHBOR_ASN;
+            } else if (rule == "oldest") {
+                config.tie_break = TieBreak::OLDEST_PATH;
+            } else {
+                std::cerr << "Unknown tie-break rule: " << rule << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], config.num_threads)) {
+                return 1;
+            }
+            if (config.num_threads == 0) {
+                config.num_threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!shard_dir.empty() && worker == (num_shards > 0)) {
+        std::cerr << "Error: --shard-dir needs either --shards <n> (coordinator) or --worker\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Lookups only read an existing matrix
+    if (!path_lookup_file.empty()) {
+        return runPathLookup(path_lookup_file, path_pairs);
+    }
+
+    // Validate required arguments (workers read them from the shard directory)
+    if (config.caida_file.empty() && !worker) {
+        std::cerr << "Error: --relationships is required\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    bool reachability_mode = !reachability_file.empty() || !reachability_matrix_file.empty() ||
+                             !path_matrix_file.empty();
+
+    if (config.announcements_file.empty() && !reachability_mode && !worker && scenarios_file.empty()) {
+        std::cerr << "Error: --announcements is required\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!PropagationRunner::isKnownEngine(config.engine)) {
+        std::cerr << "Error: Unknown engine: " << config.engine << "\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (config.engine == "vector" && !PrefixBlockEngine::isSupportedWidth(config.block_size)) {
+        std::cerr << "Error: --block-size must be 8, 16 or 32\n";
+        return 1;
+    }
+
+    // Exactly one run mode; without any mode option it is a plain run
+    std::vector<RunMode> selected;
+    if (worker) {
+        selected.push_back(RunMode::WORKER);
+    } else if (!shard_dir.empty()) {
+        selected.push_back(RunMode::SHARDS);
+    }
+    if (reachability_mode) {
+        selected.push_back(RunMode::REACHABILITY);
+    }
+    if (!config.sweep_percents.empty()) {
+        selected.push_back(RunMode::ROV_SWEEP);
+    }
+    if (!scenarios_file.empty()) {
+        selected.push_back(RunMode::SCENARIOS);
+    }
+    if (!config.what_if_file.empty()) {
+        selected.push_back(RunMode::WHAT_IF);
+    }
+    if (config.what_if_check > 0) {
+        selected.push_back(RunMode::WHAT_IF_CHECK);
+    }
+    if (!config.rov_scenarios_file.empty()) {
+        selected.push_back(RunMode::ROV_SCENARIOS);
+    }
+    if (config.placement_k > 0) {
+        selected.push_back(RunMode::ROV_PLACEMENT);
+    }
+    if (config.link_sweep) {
+        selected.push_back(RunMode::LINK_SWEEP);
+    }
+    if (!config.leak_prefix.empty()) {
+        selected.push_back(RunMode::ROUTE_LEAKS);
+    }
+    if (selected.size() > 1) {
+        std::cerr << "Error: " << getRunMode(selected[0]).name << " and " << getRunMode(selected[1]).name
+                  << " are separate runs\n";
+        return 1;
+    }
+    RunMode mode = selected.empty() ? RunMode::PLAIN : selected.front();
+
+    // Every option given must be one the mode uses. Scenarios run the bfs
+    // solver, so naming it is fine.
+    uint32_t given = 0;
+    given |= config.announcements_file.empty() ? 0 : kAnnouncementsOption;
+    given |= config.rov_asns_file.empty() ? 0 : kROVASNsOption;
+    given |= engine_given && !(mode == RunMode::SCENARIOS && config.engine == "bfs") ? kEngineOption : 0;
+    given |= config.compact ? kCompactOption : 0;
+    given |= config.vantage_file.empty() ? 0 : kVantageOption;
+    given |= config.batch_size > 0 || config.max_memory_mb > 0 ? kBatchingOption : 0;
+    given |= config.prefix_classes ? 0 : kPrefixClassesOption;
+    given |= config.tie_break != TieBreak::LOWEST_NEIGHBOR_ASN ? kTieBreakOption : 0;
+    given |= config.summary_file.empty() ? 0 : kSummaryOption;
+    given |= config.cones_file.empty() ? 0 : kConesOption;
+    given |= config.transit_load_file.empty() ? 0 : kTransitLoadOption;
+    given |= config.alternates_file.empty() ? 0 : kAlternatesOption;
+    given |= config.traceback_file.empty() ? 0 : kTracebackOption;
+    given |= config.leak_asns_file.empty() ? 0 : kLeakASNsOption;
+    for (const auto& [option, name] : kModeOptionNames) {
+        if ((given & option) && !(getRunMode(mode).accepted & option)) {
+            std::cerr << "Error: " << getRunMode(mode).name << " does not take " << name << "\n";
+            return 1;
+        }
+    }
+
+    // Placement gains, link loads and leak adopters count routes of every
+    // announced prefix, not one per class
+    if (mode == RunMode::ROV_PLACEMENT || mode == RunMode::LINK_SWEEP || mode == RunMode::ROUTE_LEAKS) {
+        config.prefix_classes = false;
+    }
+
+    // Options a plain run only takes together with some others
+    if (!config.transit_load_file.empty() && !config.vantage_file.empty()) {
+        std::cerr << "Error: --transit-load needs every AS's routes (no --vantage-asns)\n";
+        return 1;
+    }
+
+    if (!config.alternates_file.empty()) {
+        if (config.alternates_k < 1 || config.alternates_k > AlternateSet::kMaxAlternates) {
+            std::cerr << "Error: --alternates-k must be between 1 and " << AlternateSet::kMaxAlternates << "\n";
+            return 1;
+        }
+        if (config.alternates_budget_mb > (SIZE_MAX >> 20)) {
+            std::cerr << "Error: --alternates-budget-mb is too large\n";
+            return 1;
+        }
+        if (config.engine != "inbox" || config.compact) {
+            std::cerr << "Error: --alternates is kept by the inbox engine alongside the RIBs (no --compact)\n";
+            return 1;
+        }
+    }
+
+    // Only the inbox engine's exports go through Policy::shouldExport; the
+    // other engines, compaction and vantage pruning assume valley-free routing
+    if (!config.leak_asns_file.empty() &&
+        (config.engine != "inbox" || config.compact || !config.vantage_file.empty())) {
+        std::cerr << "Error: --leak-asns needs the inbox engine (no --compact or --vantage-asns)\n";
+        return 1;
+    }
+
+    // Traceback follows every RIB at once
+    if (!config.traceback_file.empty() &&
+        (config.batch_size > 0 || config.max_memory_mb > 0 || !config.vantage_file.empty())) {
+        std::cerr << "Error: --traceback needs every RIB at once (no batching or --vantage-asns)\n";
+        return 1;
+    }
+
+    if (config.engine != "inbox" && config.tie_break != TieBreak::LOWEST_NEIGHBOR_ASN) {
+        std::cerr << "Error: --engine " << config.engine << " only supports --tie-break lowest-asn\n";
+        return 1;
+    }
+
+    std::cout << "╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║                                                            ║\n";
+    std::cout << "║           BGP SIMULATOR - CLOUDFLARE EDITION               ║\n";
+    std::cout << "║                                                            ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n\n";
+
+    int status = 0;
+    if (reachability_mode) {
+        ASGraph graph;
+        status = loadGraph(config.caida_file, graph);
+        if (status != 0) {
+            return status;
+        }
+        if (!path_matrix_file.empty()) {
+            return runPathMatrix(graph, config.announcements_file, path_matrix_file, config.num_threads);
+        }
+        return runReachability(graph, config.announcements_file, reachability_file,
+                               reachability_matrix_file, config.num_threads);
+    } else if (!config.sweep_percents.empty()) {
+        status = runAdoptionSweep(config);
+    } else if (!scenarios_file.empty()) {
+        status = runScenarios(config, scenarios_file);
+    } else if (worker) {
+        // Workers may start before the coordinator has written the manifest.
+        // create() publishes it with a rename, so one that exists is complete.
+        ShardDirectory shards(shard_dir);
+        for (int waited = 0; !shards.load(); waited++) {
+            if (shards.hasManifest()) {
+                return 1;
+            }
+            if (waited == kManifestWaitSeconds) {
+                std::cerr << "Error: No shard manifest in " << shard_dir << "\n";
+                return 1;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+        std::unique_ptr<ASGraph> topology;
+        status = runShardWorker(config, shards, worker_id, topology);
+    } else if (!shard_dir.empty()) {
+        status = runCoordinator(config, shard_dir, num_shards, worker_id, shard_timeout);
+    } else {
+        status = runSimulation(config);
+    }
+    if (status != 0) {
+        return status;
+    }
+
     std::cout << "╔════════════════════════════════════════════════════════════╗\n";
     std::cout << "║                                                            ║\n";
     std::cout << "║                   SIMULATION COMPLETE                      ║\n";